@@ -2,7 +2,7 @@
 
 #include <vector>
 #include <glm/glm.hpp>
-#include <GLFW/glfw3.h>
+#include "clock.h"
 
 // Smoothly interpolates between two values
 float lerp(float start, float end, float t)
@@ -54,7 +54,10 @@ private:
 class PositionAnimator
 {
 public:
-    PositionAnimator() : animating(false), duration(0.4) {}
+    PositionAnimator() : animating(false), duration(0.4), clock(&Clock::system()) {}
+
+    // The loop's clock, so transitions follow fixed-step time in replays
+    void setClock(const Clock &source) { clock = &source; }
 
     // Start animation from current to target positions
     void startAnimation(const std::vector<glm::vec2> &start_poses,
@@ -62,7 +65,7 @@ public:
     {
         start_positions = start_poses;
         end_positions = end_poses;
-        startTime = glfwGetTime();
+        startTime = clock->now();
         animating = true;
     }
 
@@ -72,7 +75,7 @@ public:
         if (!animating)
             return;
 
-        double currentTime = glfwGetTime();
+        double currentTime = clock->now();
         double elapsedTime = currentTime - startTime;
         float progress = static_cast<float>(elapsedTime / duration);
 
@@ -103,6 +106,7 @@ private:
     bool animating;
     double startTime;
     double duration;
+    const Clock *clock;
     std::vector<glm::vec2> start_positions;
     std::vector<glm::vec2> end_positions;
 };
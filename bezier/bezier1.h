@@ -4,10 +4,30 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <fstream>
+#include <string>
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
 
 #include "../mesh.h"
+#include "../mesh_optimizer.h"
+#include "../profiler.h"
+
+// Iterative De Casteljau over any point type with + and scalar * (vec2 profiles,
+// vec3 camera paths); works on its own copy of the points. Needs one point or more.
+template <typename T>
+T deCasteljau(std::vector<T> points, float t)
+{
+    int n = points.size();
+    for (int k = 1; k < n; ++k)
+    {
+        for (int i = 0; i < n - k; ++i)
+        {
+            points[i] = (1.0f - t) * points[i] + t * points[i + 1];
+        }
+    }
+    return points[0];
+}
 
 class BezierCurve
 {
@@ -30,23 +50,47 @@ public:
         // clamp t to the valid range
         t = glm::clamp(t, 0.0f, 1.0f);
 
-        std::vector<glm::vec2> tempPoints = controlPoints;
-        int n = tempPoints.size();
+        return deCasteljau(controlPoints, t);
+    }
 
-        // iterative De Casteljau's algorithm
-        for (int k = 1; k < n; ++k)
+    // Plain text: a "BEZIER" line, the point count, then one "x y" per line.
+    // Written next to surface.off so SceneGL can tessellate the revolved surface.
+    bool writeControlPoints(const std::string &filename) const
+    {
+        std::ofstream out(filename);
+        if (!out)
         {
-            for (int i = 0; i < n - k; ++i)
-            {
-                tempPoints[i] = (1.0f - t) * tempPoints[i] + t * tempPoints[i + 1];
-            }
+            std::cerr << "[ERROR] Failed to open file for writing: " << filename << std::endl;
+            return false;
         }
+        out << "BEZIER\n"
+            << controlPoints.size() << "\n";
+        for (const glm::vec2 &p : controlPoints)
+            out << p.x << " " << p.y << "\n";
+        std::cout << "[SUCCESS] Wrote control points to " << filename << std::endl;
+        return true;
+    }
 
-        return tempPoints[0];
+    bool readControlPoints(const std::string &filename)
+    {
+        std::ifstream in(filename);
+        std::string header;
+        size_t count = 0;
+        if (!(in >> header >> count) || header != "BEZIER")
+            return false;
+        std::vector<glm::vec2> points(count);
+        for (glm::vec2 &p : points)
+        {
+            if (!(in >> p.x >> p.y))
+                return false;
+        }
+        controlPoints = points;
+        return true;
     }
 
     std::vector<glm::vec2> sampleCurve(float step = 0.1f) const
     {
+        PROFILE_SCOPE("sampleCurve");
         std::vector<glm::vec2> sampledPoints;
         if (controlPoints.empty())
         {
@@ -64,10 +108,13 @@ public:
         return sampledPoints;
     }
 
-    Mesh createSurfaceOfRevolution(int segments, float sampleStep = 0.1f) const
+    // strips: also build one restart-separated triangle strip per ring pair for drawing
+    Mesh createSurfaceOfRevolution(int segments, float sampleStep = 0.1f, bool strips = false) const
     {
+        PROFILE_SCOPE("createSurfaceOfRevolution");
         std::vector<Vertex> vertices;
         std::vector<unsigned int> indices;
+        std::vector<unsigned int> stripIndices;
 
         std::vector<glm::vec2> samples = sampleCurve(sampleStep);
         int numSamples = samples.size();
@@ -141,23 +188,43 @@ public:
                 indices.push_back(p2);
                 indices.push_back(p3);
             }
+
+            // rings have no seam vertex, so the strip wraps back to column 0
+            if (strips)
+                appendStripRow(stripIndices, i * segments, (i + 1) * segments, segments + 1, segments);
         }
 
-        return Mesh(vertices, indices);
+        optimizeMesh(vertices, indices, &stripIndices, "surface of revolution");
+        return Mesh(vertices, indices, stripIndices);
     }
 
     // Creates the Slide geometry by extruding a U-profile along the curve
-    Mesh createSlideExtrusion(float width, float wallHeight, int segments, glm::vec3 color = glm::vec3(1.0f)) const
+    Mesh createSlideExtrusion(float width, float wallHeight, int segments, glm::vec3 color = glm::vec3(1.0f), bool strips = false) const
     {
         std::vector<Vertex> vertices;
         std::vector<unsigned int> indices;
+        std::vector<unsigned int> stripIndices;
+        buildSlideExtrusion(width, wallHeight, segments, color, strips, vertices, indices, stripIndices);
+        return Mesh(vertices, indices, stripIndices);
+    }
+
+    // Same geometry as createSlideExtrusion without the GL upload, for callers
+    // that stream it (the slide is rebuilt every frame while editing)
+    void buildSlideExtrusion(float width, float wallHeight, int segments, glm::vec3 color, bool strips,
+                             std::vector<Vertex> &vertices, std::vector<unsigned int> &indices,
+                             std::vector<unsigned int> &stripIndices) const
+    {
+        PROFILE_SCOPE("buildSlideExtrusion");
+        vertices.clear();
+        indices.clear();
+        stripIndices.clear();
 
         // Sample the curve points
         std::vector<glm::vec2> samples = sampleCurve(1.0f / segments);
         int numSamples = samples.size();
 
         if (numSamples < 2)
-            return Mesh(vertices, indices);
+            return;
 
         // 1. Define the U-shaped profile (relative to the curve center)
         // 4 points: Left Wall Top -> Left Floor -> Right Floor -> Right Wall Top
@@ -232,55 +299,85 @@ public:
                 indices.push_back(next);
                 indices.push_back(next + 1);
             }
+
+            if (strips)
+                appendStripRow(stripIndices, i * vertsPerRing, (i + 1) * vertsPerRing, vertsPerRing);
         }
 
-        return Mesh(vertices, indices);
+        // No report here, the slide is rebuilt every frame while editing. With
+        // strips the GPU never draws the triangle list, so reordering it for the
+        // vertex cache and overdraw would be wasted work each frame.
+        if (strips)
+        {
+            weldVertices(vertices, indices, WeldOptions(), &stripIndices);
+            optimizeVertexFetch(vertices, indices, &stripIndices);
+        }
+        else
+        {
+            optimizeMesh(vertices, indices, &stripIndices);
+        }
     }
 
-    // to hold de Casteljau intermediate points for anim
+    // to hold de Casteljau intermediate points for anim. All levels live back to
+    // back in one triangular array (n + (n - 1) + ... + 1 points); the last level
+    // is the single point on the curve.
     struct DeCasteljauSteps
     {
-        std::vector<std::vector<glm::vec2>> levels; // Each level is one iteration
-        glm::vec2 finalPoint;                       // The point on the curve
+        struct Point
+        {
+            glm::vec2 position;
+            float level; // kept per point so all levels can be drawn at once
+        };
+        std::vector<Point> points;
+        std::vector<unsigned int> levelStart; // level k is [levelStart[k], levelStart[k + 1])
+        glm::vec2 finalPoint;                 // The point on the curve
+
+        size_t levelCount() const { return levelStart.empty() ? 0 : levelStart.size() - 1; }
+        unsigned int levelSize(size_t k) const { return levelStart[k + 1] - levelStart[k]; }
     };
 
     DeCasteljauSteps evaluateWithSteps(float t) const
     {
         DeCasteljauSteps steps;
+        evaluateWithSteps(t, steps);
+        return steps;
+    }
 
+    // Refills steps, reusing its storage so the animation does not allocate per frame
+    void evaluateWithSteps(float t, DeCasteljauSteps &steps) const
+    {
+        PROFILE_SCOPE("evaluateWithSteps");
+        steps.points.clear();
+        steps.levelStart.clear();
         if (controlPoints.empty())
         {
-            return steps;
-        }
-
-        if (controlPoints.size() == 1)
-        {
-            steps.finalPoint = controlPoints[0];
-            steps.levels.push_back({controlPoints[0]});
-            return steps;
+            return;
         }
 
         t = glm::clamp(t, 0.0f, 1.0f);
-        std::vector<glm::vec2> tempPoints = controlPoints;
-        int n = tempPoints.size();
+        size_t n = controlPoints.size();
+        steps.points.reserve(n * (n + 1) / 2);
+        steps.levelStart.reserve(n + 1);
 
         // store the initial control points
-        steps.levels.push_back(tempPoints);
+        steps.levelStart.push_back(0);
+        for (const glm::vec2 &p : controlPoints)
+            steps.points.push_back({p, 0.0f});
 
-        // iterative algo -> store each iteration
-        for (int k = 1; k < n; ++k)
+        // iterative algo -> each level interpolates the one before it
+        for (size_t k = 1; k < n; ++k)
         {
-            std::vector<glm::vec2> currentLevel;
-            for (int i = 0; i < n - k; ++i)
+            unsigned int previous = steps.levelStart.back();
+            steps.levelStart.push_back((unsigned int)steps.points.size());
+            for (size_t i = 0; i < n - k; ++i)
             {
-                tempPoints[i] = (1.0f - t) * tempPoints[i] + t * tempPoints[i + 1];
-                currentLevel.push_back(tempPoints[i]);
+                glm::vec2 p = (1.0f - t) * steps.points[previous + i].position + t * steps.points[previous + i + 1].position;
+                steps.points.push_back({p, (float)k});
             }
-            steps.levels.push_back(currentLevel);
         }
+        steps.levelStart.push_back((unsigned int)steps.points.size());
 
-        steps.finalPoint = tempPoints[0];
-        return steps;
+        steps.finalPoint = steps.points.back().position;
     }
 };
 
@@ -6,9 +6,19 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <chrono>
+#include <iomanip>
+#include <cstring>
 #include "bezier1.h"
 #include "../shader.h"
 #include "../mesh.h"
+#include "../stream_buffer.h"
+#include "../headless.h"
+#include "../clock.h"
+#include "../profiler.h"
+#include "../gpu_profiler.h"
+#include "../render_stats.h"
+#include "../text_overlay.h"
 
 const unsigned int SCR_WIDTH = 1024;
 const unsigned int SCR_HEIGHT = 768;
@@ -24,9 +34,33 @@ float animationT = 0.0f;
 float animationSpeed = 0.3f; // Speed of t parameter animation
 bool animationReverse = false;
 
-unsigned int VAO_Curve, VBO_Curve;
-unsigned int VAO_Points, VBO_Points;
-unsigned int VAO_Lines, VBO_Lines;
+// curve samples, control points and construction lines are rewritten every
+// frame, so they all go through one ring and a VAO pointing at it; the ring
+// grows with the curve, so any number of points or samples fits
+StreamBuffer streamBuffer;
+unsigned int VAO_Stream;           // plain vec2 points
+unsigned int VAO_Steps;            // De Casteljau points with their level
+unsigned int streamGeneration = 0; // ring allocation the VAOs point at
+BezierCurve::DeCasteljauSteps casteljauSteps;
+std::vector<GLint> levelFirst;
+std::vector<GLsizei> levelCount;
+const size_t STREAM_FRAME_BYTES = 64 * 1024;
+
+// GPU evaluation: curve.vert (GPU_EVAL) evaluates the samples from uniforms,
+// drawn from an attribute-less VAO
+bool gpuEvaluation = false;
+unsigned int VAO_Empty;
+const int MAX_GPU_CONTROL_POINTS = 64; // MAX_CONTROL_POINTS in curve.vert
+const float CURVE_STEP = 0.01f;
+
+// CPU profiler: I prints the per-phase stats every few seconds, J traces the next frames
+bool profileStats = false;
+const float PROFILE_PRINT_INTERVAL = 2.0f;
+const long long TRACE_FRAMES = 120;
+const char *TRACE_FILE = "../../trace_bezier.json";
+
+// Renderer counters: H shows them over the frame
+bool statsOverlay = false;
 
 GLFWwindow *g_window = nullptr;
 
@@ -52,34 +86,47 @@ int getPointIndexAt(glm::vec2 mousePos)
     return -1;
 }
 
-void setupBuffers()
+void pointStreamAttributes()
 {
-    // Curve buffer
-    glGenVertexArrays(1, &VAO_Curve);
-    glGenBuffers(1, &VBO_Curve);
-    glBindVertexArray(VAO_Curve);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_Curve);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * 1000, NULL, GL_DYNAMIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void *)0);
-    glEnableVertexAttribArray(0);
+    typedef BezierCurve::DeCasteljauSteps::Point StepPoint;
+    glBindBuffer(GL_ARRAY_BUFFER, streamBuffer.buffer());
 
-    // Points buffer
-    glGenVertexArrays(1, &VAO_Points);
-    glGenBuffers(1, &VBO_Points);
-    glBindVertexArray(VAO_Points);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_Points);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * 100, NULL, GL_DYNAMIC_DRAW);
+    glBindVertexArray(VAO_Stream);
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void *)0);
     glEnableVertexAttribArray(0);
 
-    // Lines buffer for construction lines
-    glGenVertexArrays(1, &VAO_Lines);
-    glGenBuffers(1, &VBO_Lines);
-    glBindVertexArray(VAO_Lines);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_Lines);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * 500, NULL, GL_DYNAMIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void *)0);
+    glBindVertexArray(VAO_Steps);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(StepPoint), (void *)offsetof(StepPoint, position));
     glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(StepPoint), (void *)offsetof(StepPoint, level));
+    glEnableVertexAttribArray(1);
+
+    glBindVertexArray(0);
+    streamGeneration = streamBuffer.generation();
+}
+
+void setupBuffers()
+{
+    streamBuffer.create(STREAM_FRAME_BYTES);
+    glGenVertexArrays(1, &VAO_Stream);
+    glGenVertexArrays(1, &VAO_Steps);
+    glGenVertexArrays(1, &VAO_Empty);
+    pointStreamAttributes();
+    // VAO_Stream leaves the level attribute disabled, so it reads this: plain geometry
+    glVertexAttrib1f(1, -1.0f);
+}
+
+// Copies vertices into this frame's region; first is the vertex to draw from.
+// Bind the VAO afterwards, a write that grows the ring re-points them.
+bool streamVertices(const void *data, size_t count, size_t stride, GLint &first)
+{
+    size_t offset;
+    if (!streamBuffer.write(data, count * stride, stride, offset))
+        return false;
+    if (streamGeneration != streamBuffer.generation())
+        pointStreamAttributes();
+    first = (GLint)(offset / stride);
+    return true;
 }
 
 void mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
@@ -139,93 +186,219 @@ void framebuffer_size_callback(GLFWwindow *window, int width, int height)
     glViewport(0, 0, width, height);
 }
 
-void drawDeCasteljauSteps(const BezierCurve::DeCasteljauSteps &steps, Shader &shader)
+// Curve samples on the CPU, streamed and drawn as a line strip
+void drawCurveCPU(const BezierCurve &c, float step)
 {
-    if (steps.levels.empty())
-        return;
-
-    // colors for different levels
-    std::vector<glm::vec3> colors = {
-        glm::vec3(1.0f, 0.2f, 0.2f), // Red for control points
-        glm::vec3(1.0f, 0.8f, 0.2f), // Orange
-        glm::vec3(0.2f, 1.0f, 0.8f), // Cyan
-        glm::vec3(0.6f, 0.2f, 1.0f), // Purple
-        glm::vec3(0.2f, 1.0f, 0.2f), // Green
-    };
+    PROFILE_SCOPE("drawCurveCPU");
+    GPU_PROFILE_SCOPE("drawCurveCPU");
+    std::vector<glm::vec2> curvePoints = c.sampleCurve(step);
+    GLint first;
+    if (curvePoints.size() > 1 && streamVertices(&curvePoints[0], curvePoints.size(), sizeof(glm::vec2), first))
+    {
+        glBindVertexArray(VAO_Stream);
+        glDrawArrays(GL_LINE_STRIP, first, curvePoints.size());
+    }
+}
 
-    glBindVertexArray(VAO_Lines);
+// Samples at t = i * step below 1, then t = 1 (sampleCurve without its float accumulation)
+int gpuSampleCount(float step)
+{
+    return (int)std::ceil(1.0f / step - 1e-4f) + 1;
+}
 
-    // Draw construction lines and points for each level
-    for (size_t level = 0; level < steps.levels.size(); ++level)
-    {
-        const auto &points = steps.levels[level];
-        if (points.empty())
-            continue;
+// Same strip evaluated in curve.vert; only the control points are uploaded.
+// evalShader has to be in use.
+void drawCurveGPU(const BezierCurve &c, float step, Shader &evalShader)
+{
+    PROFILE_SCOPE("drawCurveGPU");
+    GPU_PROFILE_SCOPE("drawCurveGPU");
+    int count = (int)c.controlPoints.size();
+    if (count < 2)
+        return;
+    glUniform2fv(glGetUniformLocation(evalShader.id, "uControlPoints"), count, &c.controlPoints[0].x);
+    evalShader.setInt("uControlCount", count);
+    evalShader.setFloat("uStep", step);
+    evalShader.setInt("uSampleCount", gpuSampleCount(step));
+    glBindVertexArray(VAO_Empty);
+    glDrawArrays(GL_LINE_STRIP, 0, gpuSampleCount(step));
+}
 
-        glm::vec3 color = colors[level % colors.size()];
+// --benchmark: times both curve paths for a few control point counts and
+// sampling densities. glFinish per frame, so the GPU (or llvmpipe) work counts.
+void runEvaluationBenchmark(Shader &shader, Shader &evalShader)
+{
+    const int FRAMES = 20;
+    const int controlCounts[] = {4, 16, 64};
+    const float steps[] = {0.01f, 0.001f, 0.0001f};
 
-        // draw lines connecting points in this level
-        if (points.size() > 1)
+    std::cout << "[INFO] (BENCH) ms per frame, " << FRAMES << " frames each" << std::endl;
+    std::cout << "[INFO] (BENCH) points  samples       cpu       gpu" << std::endl;
+    for (int controlCount : controlCounts)
+    {
+        BezierCurve c;
+        for (int i = 0; i < controlCount; ++i)
         {
-            glBindBuffer(GL_ARRAY_BUFFER, VBO_Lines);
-            glBufferSubData(GL_ARRAY_BUFFER, 0, points.size() * sizeof(glm::vec2), &points[0]);
+            float x = -0.9f + 1.8f * i / (controlCount - 1);
+            c.controlPoints.push_back(glm::vec2(x, 0.6f * std::sin(x * 6.0f)));
+        }
 
-            float alpha = 1.0f - (level * 0.15f); // Fade later levels slightly
-            shader.setVec3("uColor", color.r * alpha, color.g * alpha, color.b * alpha);
-            glLineWidth(2.0f - level * 0.2f);
-            glDrawArrays(GL_LINE_STRIP, 0, points.size());
+        for (float step : steps)
+        {
+            double ms[2];
+            for (int gpu = 0; gpu < 2; ++gpu)
+            {
+                // frame -1 is a warm-up that also grows the stream ring
+                auto start = std::chrono::steady_clock::now();
+                for (int frame = -1; frame < FRAMES; ++frame)
+                {
+                    if (frame == 0)
+                        start = std::chrono::steady_clock::now();
+                    glClear(GL_COLOR_BUFFER_BIT);
+                    if (gpu)
+                    {
+                        evalShader.use();
+                        evalShader.setVec3("uColor", 0.3f, 0.6f, 0.3f);
+                        drawCurveGPU(c, step, evalShader);
+                    }
+                    else
+                    {
+                        shader.use();
+                        shader.setVec3("uColor", 0.3f, 0.6f, 0.3f);
+                        drawCurveCPU(c, step);
+                    }
+                    streamBuffer.endFrame();
+                    glFinish();
+                }
+                ms[gpu] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / FRAMES;
+            }
+            std::cout << "[INFO] (BENCH) " << std::setw(6) << controlCount << std::setw(9) << gpuSampleCount(step)
+                      << std::fixed << std::setprecision(3) << std::setw(10) << ms[0] << std::setw(10) << ms[1] << std::endl;
         }
+    }
+}
+
+// All levels in one upload and two draws: a multi-draw of line strips, one per
+// level, and one point draw; curve.vert derives color, size and fade from the level
+void drawDeCasteljauSteps(const BezierCurve::DeCasteljauSteps &steps, Shader &shader)
+{
+    PROFILE_SCOPE("drawDeCasteljauSteps");
+    GPU_PROFILE_SCOPE("drawDeCasteljauSteps");
+    if (steps.points.empty())
+        return;
 
-        glBindVertexArray(VAO_Points);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO_Points);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, points.size() * sizeof(glm::vec2), &points[0]);
+    GLint first;
+    if (!streamVertices(steps.points.data(), steps.points.size(), sizeof(steps.points[0]), first))
+        return;
 
-        glPointSize(12.0f - level * 1.5f);
-        shader.setVec3("uColor", color);
-        glDrawArrays(GL_POINTS, 0, points.size());
+    levelFirst.clear();
+    levelCount.clear();
+    for (size_t level = 0; level < steps.levelCount(); ++level)
+    {
+        // draw lines connecting points in this level
+        if (steps.levelSize(level) > 1)
+        {
+            levelFirst.push_back(first + (GLint)steps.levelStart[level]);
+            levelCount.push_back((GLsizei)steps.levelSize(level));
+        }
     }
 
-    // Draw the final point on the curve with a distinctive color
-    glBindVertexArray(VAO_Points);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_Points);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(glm::vec2), &steps.finalPoint);
+    glBindVertexArray(VAO_Steps);
+    shader.setInt("uFinalLevel", (int)steps.levelCount() - 1);
+    shader.setBool("uLines", true);
+    glLineWidth(2.0f);
+    glMultiDrawArrays(GL_LINE_STRIP, levelFirst.data(), levelCount.data(), (GLsizei)levelFirst.size());
 
-    glPointSize(15.0f);
-    shader.setVec3("uColor", 1.0f, 1.0f, 0.0f); // Yellow for final point
-    glDrawArrays(GL_POINTS, 0, 1);
+    // the final point comes last, so it lands on top
+    shader.setBool("uLines", false);
+    glDrawArrays(GL_POINTS, first, (GLsizei)steps.points.size());
 }
 
-int main()
+int main(int argc, char **argv)
 {
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    GLFWwindow *window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Bezier Curve - De Casteljau Animation", NULL, NULL);
-    if (window == NULL)
+    bool benchmark = false, headless = false;
+    const char *renderStatsPath = nullptr;
+    for (int i = 1; i < argc; ++i)
     {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
+        if (std::strcmp(argv[i], "--benchmark") == 0)
+            benchmark = true;
+        else if (std::strcmp(argv[i], "--headless") == 0)
+            headless = benchmark = true; // nothing to interact with offscreen
+        else if (std::strcmp(argv[i], "--profile") == 0)
+            profileStats = true;
+        else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            Profiler::instance().captureTrace(argv[++i], 0, 0); // the whole session
+        else if (std::strcmp(argv[i], "--render-stats") == 0 && i + 1 < argc)
+            renderStatsPath = argv[++i]; // per-frame renderer counters CSV
+        else if (std::strcmp(argv[i], "--overlay") == 0)
+            statsOverlay = true;
+    }
+    Profiler &profiler = Profiler::instance();
+    if (profileStats)
+        profiler.setEnabled(true);
+
+    // --headless renders into an FBO of an EGL context, no display needed
+    GLFWwindow *window = nullptr;
+    HeadlessContext headlessContext;
+    if (headless)
+    {
+        if (!headlessContext.create(SCR_WIDTH, SCR_HEIGHT))
+            return -1;
     }
+    else
+    {
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+        window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Bezier Curve - De Casteljau Animation", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
 
-    glfwMakeContextCurrent(window);
-    g_window = window;
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetMouseButtonCallback(window, mouse_button_callback);
-    glfwSetCursorPosCallback(window, cursor_position_callback);
+        glfwMakeContextCurrent(window);
+        g_window = window;
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetMouseButtonCallback(window, mouse_button_callback);
+        glfwSetCursorPosCallback(window, cursor_position_callback);
+    }
 
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    if (!gladLoadGLLoader(headless ? (GLADloadproc)HeadlessContext::getProcAddress : (GLADloadproc)glfwGetProcAddress))
     {
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    // before any GL object exists, so the live counts start from zero
+    RenderStats &renderStats = RenderStats::instance();
+    renderStats.install();
+    if (renderStatsPath && !renderStats.openDump(renderStatsPath))
+        return -1;
+    if (headless && !headlessContext.createFramebuffer())
+        return -1;
 
     Shader shader("curve.vert", "curve.frag");
+    Shader evalShader("curve.vert", "curve.frag", nullptr, "#define GPU_EVAL");
     setupBuffers();
     glEnable(GL_PROGRAM_POINT_SIZE);
 
+    if (benchmark)
+    {
+        runEvaluationBenchmark(shader, evalShader);
+        if (headless)
+            headlessContext.destroy();
+        else
+            glfwTerminate();
+        return 0;
+    }
+
+    GpuProfiler &gpuProfiler = GpuProfiler::instance();
+    gpuProfiler.create();
+    TextOverlay textOverlay;
+    textOverlay.create();
+
     // init points
     curve.controlPoints.push_back(glm::vec2(-0.6f, -0.4f));
     curve.controlPoints.push_back(glm::vec2(-0.2f, 0.6f));
@@ -237,16 +410,25 @@ int main()
     std::cout << "  Right Click - Delete point" << std::endl;
     std::cout << "  SPACE - Toggle De Casteljau animation" << std::endl;
     std::cout << "  UP/DOWN - Adjust animation speed" << std::endl;
+    std::cout << "  G - Toggle GPU curve evaluation" << std::endl;
+    std::cout << "  I - Toggle the CPU profiler (per-phase stats every " << PROFILE_PRINT_INTERVAL << " s)" << std::endl;
+    std::cout << "  J - Trace the next " << TRACE_FRAMES << " frames to " << TRACE_FILE << std::endl;
+    std::cout << "  H - Toggle the renderer stats overlay (draws, uploads, live GL objects)" << std::endl;
 
-    float lastTime = glfwGetTime();
+    const Clock &clock = Clock::system();
+    float lastTime = clock.now();
+    float lastProfilePrintTime = lastTime;
 
     while (!glfwWindowShouldClose(window))
     {
-        float currentTime = glfwGetTime();
+        float currentTime = clock.now();
         float deltaTime = currentTime - lastTime;
         lastTime = currentTime;
+        profiler.beginFrame();
+        gpuProfiler.beginFrame();
 
         // Input
+        ProfileScope inputScope("input");
         if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
             glfwSetWindowShouldClose(window, true);
 
@@ -276,6 +458,7 @@ int main()
             if (sorMesh.vertices.size() > 0)
             {
                 sorMesh.writeOFF("../../surface.off");
+                curve.writeControlPoints("../../surface.curve");
             }
             else
             {
@@ -288,6 +471,57 @@ int main()
             sPressed = false;
         }
 
+        static bool gPressed = false;
+        if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS && !gPressed)
+        {
+            gpuEvaluation = !gpuEvaluation;
+            gPressed = true;
+            std::cout << "GPU curve evaluation: " << (gpuEvaluation ? "ON" : "OFF") << std::endl;
+            if (gpuEvaluation && (int)curve.controlPoints.size() > MAX_GPU_CONTROL_POINTS)
+                std::cout << "[WARN] more than " << MAX_GPU_CONTROL_POINTS << " control points, the curve stays on the CPU" << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_G) == GLFW_RELEASE)
+        {
+            gPressed = false;
+        }
+
+        static bool iPressed = false;
+        if (glfwGetKey(window, GLFW_KEY_I) == GLFW_PRESS && !iPressed)
+        {
+            profileStats = !profileStats;
+            iPressed = true;
+            profiler.setEnabled(profileStats || profiler.capturing());
+            std::cout << "CPU profiler: " << (profileStats ? "ON" : "OFF") << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_I) == GLFW_RELEASE)
+        {
+            iPressed = false;
+        }
+
+        static bool jPressed = false;
+        if (glfwGetKey(window, GLFW_KEY_J) == GLFW_PRESS && !jPressed)
+        {
+            jPressed = true;
+            if (!profiler.capturing())
+                profiler.captureTrace(TRACE_FILE, profiler.frameIndex() + 1, TRACE_FRAMES);
+        }
+        if (glfwGetKey(window, GLFW_KEY_J) == GLFW_RELEASE)
+        {
+            jPressed = false;
+        }
+
+        static bool hPressed = false;
+        if (glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS && !hPressed)
+        {
+            hPressed = true;
+            statsOverlay = !statsOverlay;
+            std::cout << "Renderer stats overlay: " << (statsOverlay ? "ON" : "OFF") << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_H) == GLFW_RELEASE)
+        {
+            hPressed = false;
+        }
+
         // Adjust speed
         if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
         {
@@ -300,6 +534,8 @@ int main()
             std::cout << "Speed: " << animationSpeed << std::endl;
         }
 
+        inputScope.stop();
+
         // Update animation
         if (animateCasteljau && curve.controlPoints.size() >= 2)
         {
@@ -328,51 +564,72 @@ int main()
         shader.use();
 
         // Draw full curve
-        std::vector<glm::vec2> curvePoints = curve.sampleCurve(0.01f);
-        if (curvePoints.size() > 1)
+        glLineWidth(1.5f);
+        if (gpuEvaluation && (int)curve.controlPoints.size() <= MAX_GPU_CONTROL_POINTS)
+        {
+            evalShader.use();
+            evalShader.setVec3("uColor", 0.3f, 0.6f, 0.3f);
+            drawCurveGPU(curve, CURVE_STEP, evalShader);
+            shader.use();
+        }
+        else
         {
-            glBindVertexArray(VAO_Curve);
-            glBindBuffer(GL_ARRAY_BUFFER, VBO_Curve);
-            glBufferSubData(GL_ARRAY_BUFFER, 0, curvePoints.size() * sizeof(glm::vec2), &curvePoints[0]);
-            glLineWidth(1.5f);
             shader.setVec3("uColor", 0.3f, 0.6f, 0.3f);
-            glDrawArrays(GL_LINE_STRIP, 0, curvePoints.size());
+            drawCurveCPU(curve, CURVE_STEP);
         }
+        GLint first;
 
         //  control polygon
-        if (curve.controlPoints.size() > 0)
+        if (curve.controlPoints.size() > 0 && streamVertices(&curve.controlPoints[0], curve.controlPoints.size(), sizeof(glm::vec2), first))
         {
-            glBindVertexArray(VAO_Points);
-            glBindBuffer(GL_ARRAY_BUFFER, VBO_Points);
-            glBufferSubData(GL_ARRAY_BUFFER, 0, curve.controlPoints.size() * sizeof(glm::vec2), &curve.controlPoints[0]);
-
+            PROFILE_SCOPE("controlPolygon");
+            GPU_PROFILE_SCOPE("controlPolygon");
+            glBindVertexArray(VAO_Stream);
             float dimFactor = animateCasteljau ? 0.3f : 1.0f;
             shader.setVec3("uColor", 0.5f * dimFactor, 0.5f * dimFactor, 0.5f * dimFactor);
             glLineWidth(1.0f);
-            glDrawArrays(GL_LINE_STRIP, 0, curve.controlPoints.size());
+            glDrawArrays(GL_LINE_STRIP, first, curve.controlPoints.size());
 
-            glPointSize(8.0f);
+            shader.setFloat("uPointSize", 8.0f);
             shader.setVec3("uColor", 0.8f * dimFactor, 0.2f * dimFactor, 0.2f * dimFactor);
-            glDrawArrays(GL_POINTS, 0, curve.controlPoints.size());
+            glDrawArrays(GL_POINTS, first, curve.controlPoints.size());
         }
 
         // draw de Casteljau steps if animating
         if (animateCasteljau && curve.controlPoints.size() >= 2)
         {
-            BezierCurve::DeCasteljauSteps steps = curve.evaluateWithSteps(animationT);
-            drawDeCasteljauSteps(steps, shader);
+            curve.evaluateWithSteps(animationT, casteljauSteps);
+            drawDeCasteljauSteps(casteljauSteps, shader);
         }
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
-    }
+        renderStats.endFrame();
+        if (statsOverlay)
+            renderStats.drawOverlay(textOverlay);
 
-    glDeleteVertexArrays(1, &VAO_Curve);
-    glDeleteBuffers(1, &VBO_Curve);
-    glDeleteVertexArrays(1, &VAO_Points);
-    glDeleteBuffers(1, &VBO_Points);
-    glDeleteVertexArrays(1, &VAO_Lines);
-    glDeleteBuffers(1, &VBO_Lines);
+        streamBuffer.endFrame();
+        gpuProfiler.endFrame();
+        {
+            PROFILE_SCOPE("swapBuffers");
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+        profiler.endFrame();
+
+        if (profileStats && currentTime - lastProfilePrintTime > PROFILE_PRINT_INTERVAL)
+        {
+            lastProfilePrintTime = currentTime;
+            profiler.printStats();
+        }
+    }
+    profiler.finish();
+
+    glDeleteVertexArrays(1, &VAO_Stream);
+    glDeleteVertexArrays(1, &VAO_Steps);
+    glDeleteVertexArrays(1, &VAO_Empty);
+    renderStats.finish();
+    textOverlay.destroy();
+    gpuProfiler.destroy();
+    streamBuffer.destroy();
 
     glfwTerminate();
     return 0;
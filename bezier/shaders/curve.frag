@@ -1,7 +1,7 @@
 #version 330 core
 out vec4 FragColor;
-uniform vec3 uColor;
+flat in vec3 vColor;
 void main()
 {
-    FragColor = vec4(uColor, 1.0);
+    FragColor = vec4(vColor, 1.0);
 }
\ No newline at end of file
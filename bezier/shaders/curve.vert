@@ -1,6 +1,74 @@
 #version 330 core
+#ifdef GPU_EVAL
+// The curve is evaluated here: vertex i is the sample at t = i * uStep (the last one at t = 1),
+// so the CPU only uploads the control points whatever the sampling density
+#define MAX_CONTROL_POINTS 64
+uniform vec2 uControlPoints[MAX_CONTROL_POINTS];
+uniform int uControlCount;
+uniform float uStep;
+uniform int uSampleCount;
+#else
 layout (location = 0) in vec2 aPos;
+#endif
+layout (location = 1) in float aLevel; // De Casteljau level, -1 for plain geometry
+
+uniform vec3 uColor;
+uniform float uPointSize;
+uniform int uFinalLevel; // level holding the point on the curve
+uniform bool uLines;     // construction lines fade with their level
+
+flat out vec3 vColor;
+
+const vec3 LEVEL_COLORS[5] = vec3[](
+    vec3(1.0, 0.2, 0.2), // Red for control points
+    vec3(1.0, 0.8, 0.2), // Orange
+    vec3(0.2, 1.0, 0.8), // Cyan
+    vec3(0.6, 0.2, 1.0), // Purple
+    vec3(0.2, 1.0, 0.2)  // Green
+);
+
+#ifdef GPU_EVAL
+// Bernstein form: O(n) per vertex and no local array (a De Casteljau scratch array
+// of 64 points miscompiles on llvmpipe). The weights are built up from the end
+// nearer to t, so the ratio s / (1 - s) stays <= 1 and nothing overflows.
+vec2 evaluateCurve(float t)
+{
+    int degree = uControlCount - 1;
+    bool reversed = t > 0.5;
+    float s = reversed ? 1.0 - t : t;
+    float ratio = s / (1.0 - s);
+    float weight = pow(1.0 - s, float(degree));
+    vec2 sum = vec2(0.0);
+    for (int i = 0; i <= degree; ++i)
+    {
+        sum += weight * uControlPoints[reversed ? degree - i : i];
+        weight *= ratio * float(degree - i) / float(i + 1);
+    }
+    return sum;
+}
+#endif
+
 void main()
 {
+#ifdef GPU_EVAL
+    float t = (gl_VertexID == uSampleCount - 1) ? 1.0 : float(gl_VertexID) * uStep;
+    vec2 aPos = evaluateCurve(t);
+#endif
     gl_Position = vec4(aPos.x, aPos.y, 0.0, 1.0);
-}
\ No newline at end of file
+    vColor = uColor;
+    gl_PointSize = uPointSize;
+    if (aLevel < 0.0)
+        return;
+
+    int level = int(aLevel + 0.5);
+    if (level == uFinalLevel && !uLines)
+    {
+        vColor = vec3(1.0, 1.0, 0.0); // Yellow for final point
+        gl_PointSize = 15.0;
+        return;
+    }
+    vColor = LEVEL_COLORS[level % 5];
+    if (uLines)
+        vColor *= 1.0 - level * 0.15; // Fade later levels slightly
+    gl_PointSize = max(12.0 - level * 1.5, 2.0);
+}
@@ -106,6 +106,16 @@ public:
         updateCameraVectors();
     }
 
+    // For scripted cameras, angles in degrees
+    void setPose(const glm::vec3 &newPosition, float newYaw, float newPitch, float newRoll = 0.0f)
+    {
+        position = newPosition;
+        yaw = newYaw;
+        pitch = newPitch;
+        roll = newRoll;
+        updateCameraVectors();
+    }
+
 private:
     void updateCameraVectors()
     {
@@ -0,0 +1,176 @@
+#ifndef CAMERA_PATH_H
+#define CAMERA_PATH_H
+
+#include <glm/glm.hpp>
+#include "bezier/bezier1.h"
+#include "camera.h"
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+// A camera pose; angles are Camera's yaw, pitch and roll in degrees
+struct CameraKeyframe
+{
+    glm::vec3 position;
+    glm::vec3 angles;
+};
+
+// Camera route through keyframes. Every span between two keyframes is a cubic
+// Bezier with Catmull-Rom tangents, evaluated with the same De Casteljau code as
+// the curve editor, over the position and over the angles, so the route passes
+// through each keyframe without a kink. Playback is by distance along the route,
+// looked up in an arc-length table, so the speed stays constant however
+// unevenly the keyframes are spaced.
+class CameraPath
+{
+public:
+    static constexpr int SAMPLES_PER_SPAN = 64;
+    static constexpr float DEGREES_PER_UNIT = 45.0f; // turning counts as travel, so turns in place still take time
+
+    std::vector<CameraKeyframe> keyframes;
+
+    void addKeyframe(const Camera &camera)
+    {
+        addKeyframe(camera.position, camera.yaw, camera.pitch, camera.roll);
+    }
+
+    // Yaw and roll are unwrapped against the previous keyframe, so the camera
+    // turns the short way round
+    void addKeyframe(const glm::vec3 &position, float yaw, float pitch, float roll = 0.0f)
+    {
+        CameraKeyframe k{position, glm::vec3(yaw, pitch, roll)};
+        if (!keyframes.empty())
+        {
+            const glm::vec3 &previous = keyframes.back().angles;
+            k.angles.x = previous.x + wrapDegrees(k.angles.x - previous.x);
+            k.angles.z = previous.z + wrapDegrees(k.angles.z - previous.z);
+        }
+        keyframes.push_back(k);
+        build();
+    }
+
+    void clear()
+    {
+        keyframes.clear();
+        build();
+    }
+
+    // Recomputes the spans and the arc-length table after editing keyframes
+    void build()
+    {
+        spans.clear();
+        arcLength.assign(1, 0.0f);
+        if (keyframes.size() < 2)
+            return;
+
+        for (size_t i = 0; i + 1 < keyframes.size(); ++i)
+        {
+            const CameraKeyframe &k0 = keyframes[i > 0 ? i - 1 : i];
+            const CameraKeyframe &k1 = keyframes[i];
+            const CameraKeyframe &k2 = keyframes[i + 1];
+            const CameraKeyframe &k3 = keyframes[std::min(i + 2, keyframes.size() - 1)];
+            Span span;
+            span.position = {k1.position, k1.position + (k2.position - k0.position) / 6.0f,
+                             k2.position - (k3.position - k1.position) / 6.0f, k2.position};
+            span.angles = {k1.angles, k1.angles + (k2.angles - k0.angles) / 6.0f,
+                           k2.angles - (k3.angles - k1.angles) / 6.0f, k2.angles};
+            spans.push_back(span);
+        }
+
+        glm::vec3 previousPosition = keyframes[0].position, previousAngles = keyframes[0].angles;
+        for (const Span &span : spans)
+        {
+            for (int j = 1; j <= SAMPLES_PER_SPAN; ++j)
+            {
+                float t = (float)j / SAMPLES_PER_SPAN;
+                glm::vec3 position = deCasteljau(span.position, t), angles = deCasteljau(span.angles, t);
+                float step = glm::length(position - previousPosition) + glm::length(angles - previousAngles) / DEGREES_PER_UNIT;
+                arcLength.push_back(arcLength.back() + step);
+                previousPosition = position;
+                previousAngles = angles;
+            }
+        }
+    }
+
+    bool playable() const { return !spans.empty() && length() > 0.0f; }
+    float length() const { return arcLength.back(); }
+
+    // Pose at a distance along the route, clamped to its ends
+    CameraKeyframe evaluate(float distance) const
+    {
+        if (spans.empty())
+            return keyframes.empty() ? CameraKeyframe{glm::vec3(0.0f), glm::vec3(YAW, PITCH, 0.0f)} : keyframes[0];
+
+        distance = glm::clamp(distance, 0.0f, length());
+        size_t sample = std::upper_bound(arcLength.begin(), arcLength.end(), distance) - arcLength.begin();
+        sample = glm::clamp(sample, (size_t)1, arcLength.size() - 1);
+        float segment = arcLength[sample] - arcLength[sample - 1];
+        float fraction = (segment > 0.0f) ? (distance - arcLength[sample - 1]) / segment : 0.0f;
+
+        float u = ((float)(sample - 1) + fraction) / SAMPLES_PER_SPAN;
+        size_t index = std::min((size_t)u, spans.size() - 1);
+        float t = glm::clamp(u - (float)index, 0.0f, 1.0f);
+        return {deCasteljau(spans[index].position, t), deCasteljau(spans[index].angles, t)};
+    }
+
+    void apply(Camera &camera, float distance) const
+    {
+        CameraKeyframe k = evaluate(distance);
+        camera.setPose(k.position, k.angles.x, k.angles.y, wrapDegrees(k.angles.z));
+    }
+
+    // Plain text: a "CAMPATH" line, the keyframe count, then "x y z yaw pitch roll" per line
+    bool save(const std::string &filename) const
+    {
+        std::ofstream out(filename);
+        if (!out)
+        {
+            std::cerr << "[ERROR] Failed to open file for writing: " << filename << std::endl;
+            return false;
+        }
+        out << "CAMPATH\n"
+            << keyframes.size() << "\n";
+        for (const CameraKeyframe &k : keyframes)
+            out << k.position.x << " " << k.position.y << " " << k.position.z << " "
+                << k.angles.x << " " << k.angles.y << " " << k.angles.z << "\n";
+        return true;
+    }
+
+    bool load(const std::string &filename)
+    {
+        std::ifstream in(filename);
+        std::string header;
+        size_t count = 0;
+        if (!(in >> header >> count) || header != "CAMPATH")
+            return false;
+        std::vector<CameraKeyframe> loaded(count);
+        for (CameraKeyframe &k : loaded)
+        {
+            if (!(in >> k.position.x >> k.position.y >> k.position.z >> k.angles.x >> k.angles.y >> k.angles.z))
+                return false;
+        }
+        keyframes = loaded;
+        build();
+        return true;
+    }
+
+private:
+    struct Span
+    {
+        std::vector<glm::vec3> position; // 4 control points
+        std::vector<glm::vec3> angles;
+    };
+    std::vector<Span> spans;
+    std::vector<float> arcLength = {0.0f}; // route length at every sample
+
+    static float wrapDegrees(float degrees)
+    {
+        return degrees - 360.0f * std::floor((degrees + 180.0f) / 360.0f);
+    }
+};
+
+#endif
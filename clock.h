@@ -0,0 +1,54 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <chrono>
+
+// Time source for the main loops and animators, in seconds. Interactive runs
+// use wall-clock time; headless and replayed runs step a fixed amount per
+// frame so every run animates through exactly the same states.
+class Clock
+{
+public:
+    virtual ~Clock() {}
+    virtual double now() const = 0;
+
+    // Shared wall clock, the default for animators
+    static const Clock &system();
+};
+
+// Seconds since the clock was created
+class SystemClock : public Clock
+{
+public:
+    SystemClock() : start(std::chrono::steady_clock::now()) {}
+
+    double now() const override
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+// Advances by step on each advance() call, once per frame
+class FixedStepClock : public Clock
+{
+public:
+    explicit FixedStepClock(double step) : step(step) {}
+
+    double now() const override { return frames * step; }
+    void advance() { frames++; }
+
+private:
+    double step;
+    long long frames = 0; // time from a count, so it doesn't drift over long runs
+};
+
+inline const Clock &Clock::system()
+{
+    static SystemClock clock;
+    return clock;
+}
+
+#endif
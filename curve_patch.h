@@ -0,0 +1,132 @@
+#ifndef CURVE_PATCH_H
+#define CURVE_PATCH_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "shader.h"
+#include "stream_buffer.h"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+enum CurvePatchType
+{
+    PATCH_SLIDE = 0,      // the slide's U profile swept along the curve
+    PATCH_REVOLUTION = 1, // the curve (radius, height) revolved around y
+};
+
+// A Bezier curve asset drawn as a single GL_PATCHES primitive: the control
+// points are the patch vertices and patch.tess evaluates the surface, picking
+// per-edge tessellation levels from the edges' projected length, so no dense
+// CPU-side mesh is needed. Needs GL 4.0.
+class CurvePatch
+{
+public:
+    // layout(vertices) in patch.tess, the minimum GL_MAX_PATCH_VERTICES
+    static constexpr size_t MAX_CONTROL_POINTS = 32;
+
+    CurvePatchType type = PATCH_SLIDE;
+    std::vector<glm::vec2> controlPoints;
+    glm::vec3 color = glm::vec3(1.0f);
+    float width = 0.0f; // slide profile
+    float wallHeight = 0.0f;
+    glm::vec3 boundsMin = glm::vec3(0.0f); // conservative, from the control polygon
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    GLuint VAO = 0; // created by slide() and revolution(), so render queue keys can use it up front
+
+    static bool supported() { return GLAD_GL_VERSION_4_0 != 0; }
+
+    static CurvePatch slide(const std::vector<glm::vec2> &points, float width, float wallHeight, glm::vec3 color)
+    {
+        CurvePatch patch;
+        patch.type = PATCH_SLIDE;
+        patch.width = width;
+        patch.wallHeight = wallHeight;
+        patch.color = color;
+        patch.setControlPoints(points);
+        glGenVertexArrays(1, &patch.VAO);
+        return patch;
+    }
+
+    static CurvePatch revolution(const std::vector<glm::vec2> &points, glm::vec3 color)
+    {
+        CurvePatch patch;
+        patch.type = PATCH_REVOLUTION;
+        patch.color = color;
+        patch.setControlPoints(points);
+        glGenVertexArrays(1, &patch.VAO);
+        return patch;
+    }
+
+    void destroy()
+    {
+        glDeleteVertexArrays(1, &VAO);
+        VAO = 0;
+        streamGeneration = 0;
+    }
+
+    bool drawable() const { return controlPoints.size() >= 2 && controlPoints.size() <= MAX_CONTROL_POINTS; }
+
+    // the curve lies in the convex hull of its control points
+    void setControlPoints(const std::vector<glm::vec2> &points)
+    {
+        controlPoints = points;
+        if (points.empty())
+            return;
+        glm::vec2 lo = points[0], hi = points[0];
+        for (const glm::vec2 &p : points)
+        {
+            lo = glm::min(lo, p);
+            hi = glm::max(hi, p);
+        }
+        if (type == PATCH_REVOLUTION)
+        {
+            float radius = std::max(std::abs(lo.x), std::abs(hi.x));
+            boundsMin = glm::vec3(-radius, lo.y, -radius);
+            boundsMax = glm::vec3(radius, hi.y, radius);
+        }
+        else
+        {
+            float reach = std::max(width * 0.5f, wallHeight);
+            boundsMin = glm::vec3(lo, 0.0f) - glm::vec3(reach);
+            boundsMax = glm::vec3(hi, 0.0f) + glm::vec3(reach);
+        }
+    }
+
+    // Control points go through the ring each draw; they are a few dozen bytes.
+    // Leaves VAO bound.
+    void draw(Shader &shader, StreamBuffer &ring)
+    {
+        if (!drawable())
+            return;
+        size_t offset;
+        if (!ring.write(controlPoints.data(), controlPoints.size() * sizeof(glm::vec2), sizeof(glm::vec2), offset))
+            return;
+        if (streamGeneration != ring.generation())
+            pointAt(ring);
+        glBindVertexArray(VAO);
+
+        shader.setInt("patchType", type);
+        shader.setInt("controlCount", (int)controlPoints.size());
+        shader.setFloat("slideWidth", width);
+        shader.setFloat("wallHeight", wallHeight);
+        shader.setVec3("patchColor", color);
+        glPatchParameteri(GL_PATCH_VERTICES, (GLint)controlPoints.size());
+        glDrawArrays(GL_PATCHES, (GLint)(offset / sizeof(glm::vec2)), (GLsizei)controlPoints.size());
+    }
+
+private:
+    unsigned int streamGeneration = 0;
+
+    void pointAt(StreamBuffer &ring)
+    {
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, ring.buffer());
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void *)0);
+        glEnableVertexAttribArray(0);
+        streamGeneration = ring.generation();
+    }
+};
+
+#endif
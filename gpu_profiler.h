@@ -0,0 +1,188 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <glad/glad.h>
+#include "profiler.h"
+
+#include <vector>
+#include <cstdint>
+#include <iostream>
+
+// GPU time of render passes and draw batches. Every scope puts a GL_TIMESTAMP
+// query at its start and end (timestamps nest, GL_TIME_ELAPSED queries don't).
+// The queries of a frame live in one of LATENCY slots and are read back when
+// that slot comes round again, LATENCY frames later; results that still aren't
+// available then are dropped rather than waited for, so collecting never
+// stalls the pipeline. Results go into the CPU profiler's statistics and
+// traces as "gpu <name>", and only while it is enabled.
+class GpuProfiler
+{
+public:
+    static const int LATENCY = 4;             // frames between issuing and reading a frame's queries
+    static const int CALIBRATE_INTERVAL = 120; // frames between GPU/CPU clock alignments
+
+    static GpuProfiler &instance()
+    {
+        static GpuProfiler profiler;
+        return profiler;
+    }
+
+    // Needs a current GL 3.3 context, where timer queries are core
+    bool create()
+    {
+        GLint bits = 0;
+        glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+        supported = bits > 0;
+        if (!supported)
+            std::cout << "[WARN] (PROFILE) no GPU timestamp queries, GPU phases are not timed" << std::endl;
+        return supported;
+    }
+
+    void destroy()
+    {
+        if (dropped > 0)
+            std::cout << "[INFO] (PROFILE) GPU timings of " << dropped << " frames were not ready in time and were dropped" << std::endl;
+        for (Frame &f : frames)
+        {
+            if (!f.queries.empty())
+                glDeleteQueries((GLsizei)f.queries.size(), f.queries.data());
+            f = Frame();
+        }
+        supported = false;
+    }
+
+    void beginFrame()
+    {
+        recording = false;
+        if (!supported)
+            return;
+        Frame &f = frames[frame % LATENCY];
+        collect(f);
+        f.used = 0;
+        f.scopes.clear();
+
+        if (!Profiler::enabled())
+            return;
+        if (frame % CALIBRATE_INTERVAL == 0 || !calibrated)
+            calibrate();
+        recording = true;
+        frameScope = begin("frame");
+    }
+
+    void endFrame()
+    {
+        end(frameScope);
+        frameScope = -1;
+        recording = false;
+        frame++;
+    }
+
+    // Returns a handle for end(), -1 while not recording
+    int begin(const char *name)
+    {
+        if (!recording)
+            return -1;
+        Frame &f = frames[frame % LATENCY];
+        f.scopes.push_back({name, timestamp(f), NONE});
+        return (int)f.scopes.size() - 1;
+    }
+
+    void end(int scope)
+    {
+        if (scope < 0 || !recording)
+            return;
+        Frame &f = frames[frame % LATENCY];
+        f.scopes[scope].end = timestamp(f);
+    }
+
+private:
+    static const size_t NONE = SIZE_MAX;
+
+    struct Scope
+    {
+        const char *name;
+        size_t begin, end; // query indices
+    };
+
+    struct Frame
+    {
+        std::vector<GLuint> queries; // grows to the busiest frame, then reused
+        size_t used = 0;
+        std::vector<Scope> scopes;
+        std::vector<GLuint64> results;
+    };
+
+    Frame frames[LATENCY];
+    long long frame = 0;
+    bool supported = false;
+    bool recording = false;
+    int frameScope = -1;
+    size_t dropped = 0; // frames whose results were not ready in time
+    int64_t gpuToCpu = 0; // ns added to GPU timestamps to get profiler time
+    bool calibrated = false;
+
+    GpuProfiler() {}
+
+    size_t timestamp(Frame &f)
+    {
+        if (f.used == f.queries.size())
+        {
+            GLuint query;
+            glGenQueries(1, &query);
+            f.queries.push_back(query);
+        }
+        glQueryCounter(f.queries[f.used], GL_TIMESTAMP);
+        return f.used++;
+    }
+
+    // The GPU clock has its own origin; pairs it with the profiler's clock
+    void calibrate()
+    {
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        gpuToCpu = (int64_t)Profiler::now() - (int64_t)gpuNow;
+        calibrated = true;
+    }
+
+    void collect(Frame &f)
+    {
+        if (f.used == 0)
+            return;
+        // queries complete in order, so the last one being ready means all are
+        GLint available = 0;
+        glGetQueryObjectiv(f.queries[f.used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+        {
+            dropped++;
+            return;
+        }
+        f.results.resize(f.used);
+        for (size_t i = 0; i < f.used; ++i)
+            glGetQueryObjectui64v(f.queries[i], GL_QUERY_RESULT, &f.results[i]);
+        Profiler &profiler = Profiler::instance();
+        for (const Scope &scope : f.scopes)
+        {
+            if (scope.end != NONE)
+                profiler.recordGpu(scope.name, (uint64_t)((int64_t)f.results[scope.begin] + gpuToCpu),
+                                   (uint64_t)((int64_t)f.results[scope.end] + gpuToCpu));
+        }
+    }
+};
+
+// Times its own lifetime on the GPU; use through GPU_PROFILE_SCOPE
+class GpuProfileScope
+{
+public:
+    explicit GpuProfileScope(const char *name) : scope(GpuProfiler::instance().begin(name)) {}
+    ~GpuProfileScope() { GpuProfiler::instance().end(scope); }
+
+    GpuProfileScope(const GpuProfileScope &) = delete;
+    GpuProfileScope &operator=(const GpuProfileScope &) = delete;
+
+private:
+    int scope;
+};
+
+#define GPU_PROFILE_SCOPE(name) GpuProfileScope PROFILE_JOIN(gpuProfileScope, __LINE__)(name)
+
+#endif
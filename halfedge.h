@@ -0,0 +1,220 @@
+#ifndef HALFEDGE_H
+#define HALFEDGE_H
+
+#include <glm/glm.hpp>
+#include "mesh.h"
+
+#include <vector>
+#include <unordered_map>
+#include <cstring>
+#include <cstdint>
+
+// Index-based half-edge structure over a triangle list.
+// Half-edge h belongs to face h / 3 and runs from origin[h] to origin[next(h)],
+// so next/prev/face are implicit and only origin, twin and corner are stored.
+// Topological vertices can be welded by position while corner keeps the source
+// vertex index, so attribute seams survive the round trip back to indices.
+class HalfEdgeMesh
+{
+public:
+    static constexpr unsigned int INVALID = 0xFFFFFFFF;
+
+    std::vector<unsigned int> origin;       // topological vertex the half-edge leaves
+    std::vector<unsigned int> corner;       // source vertex index at that corner
+    std::vector<unsigned int> twin;         // opposite half-edge, INVALID on borders
+    std::vector<unsigned int> vertexEdge;   // one outgoing half-edge per vertex (a border one if any)
+    std::vector<unsigned int> vertexSource; // a source vertex index for each topological vertex
+    size_t nonManifoldEdges = 0;
+
+    HalfEdgeMesh() {}
+
+    // weldPositions: vertices with equal positions become one topological vertex
+    HalfEdgeMesh(const Mesh &mesh, bool weldPositions = true)
+    {
+        build(mesh.vertices, mesh.indices, weldPositions);
+    }
+
+    // Linear time: every directed edge goes into a hash, twins are looked up by
+    // the reversed key. Directed edges seen twice (non-manifold or inconsistent
+    // winding) stay unpaired and are counted in nonManifoldEdges.
+    void build(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices, bool weldPositions = true)
+    {
+        size_t count = indices.size() - indices.size() % 3;
+        std::vector<unsigned int> topology(vertices.size());
+        vertexSource.clear();
+        if (weldPositions)
+        {
+            struct PositionHash
+            {
+                size_t operator()(const glm::vec3 &p) const
+                {
+                    glm::vec3 q = p + glm::vec3(0.0f); // -0.0 and 0.0 hash the same
+                    uint32_t w[3];
+                    std::memcpy(w, &q, sizeof(w));
+                    return (w[0] * 73856093u) ^ (w[1] * 19349663u) ^ (w[2] * 83492791u);
+                }
+            };
+            std::unordered_map<glm::vec3, unsigned int, PositionHash> ids;
+            ids.reserve(vertices.size());
+            for (size_t v = 0; v < vertices.size(); ++v)
+            {
+                auto it = ids.emplace(vertices[v].position, (unsigned int)vertexSource.size());
+                if (it.second)
+                    vertexSource.push_back((unsigned int)v);
+                topology[v] = it.first->second;
+            }
+        }
+        else
+        {
+            for (size_t v = 0; v < vertices.size(); ++v)
+            {
+                topology[v] = (unsigned int)v;
+                vertexSource.push_back((unsigned int)v);
+            }
+        }
+
+        std::vector<unsigned int> welded(count);
+        for (size_t h = 0; h < count; ++h)
+            welded[h] = topology[indices[h]];
+        buildTopology(welded, vertexSource.size());
+        corner.assign(indices.begin(), indices.begin() + count);
+    }
+
+    // Indices that already refer to vertexCount topological vertices
+    void build(const std::vector<unsigned int> &indices, size_t vertexCount)
+    {
+        vertexSource.resize(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v)
+            vertexSource[v] = (unsigned int)v;
+        buildTopology(indices, vertexCount);
+        corner = origin;
+    }
+
+    size_t halfEdgeCount() const { return origin.size(); }
+    size_t faceCount() const { return origin.size() / 3; }
+    size_t vertexCount() const { return vertexEdge.size(); }
+
+    static unsigned int next(unsigned int h) { return (h % 3 == 2) ? h - 2 : h + 1; }
+    static unsigned int prev(unsigned int h) { return (h % 3 == 0) ? h + 2 : h - 1; }
+    static unsigned int face(unsigned int h) { return h / 3; }
+    unsigned int destination(unsigned int h) const { return origin[next(h)]; }
+
+    bool isBorderEdge(unsigned int h) const { return twin[h] == INVALID; }
+    bool isBorderVertex(unsigned int v) const { return vertexEdge[v] != INVALID && twin[vertexEdge[v]] == INVALID; }
+
+    // Calls f(h) for each outgoing half-edge of v, counter-clockwise. Around a
+    // border vertex the walk starts at the border edge and ends at the other side;
+    // at a non-manifold vertex only the fan holding vertexEdge[v] is visited.
+    template <typename F>
+    void forEachOutgoing(unsigned int v, F f) const
+    {
+        unsigned int start = vertexEdge[v];
+        if (start == INVALID)
+            return;
+        unsigned int h = start;
+        do
+        {
+            f(h);
+            h = twin[prev(h)];
+        } while (h != INVALID && h != start);
+    }
+
+    // Calls f(u) for every vertex sharing an edge with v
+    template <typename F>
+    void forEachNeighbor(unsigned int v, F f) const
+    {
+        unsigned int last = INVALID;
+        forEachOutgoing(v, [&](unsigned int h)
+                        {
+                            f(destination(h));
+                            last = h; });
+        // the incoming border edge closing an open fan has no outgoing twin
+        if (last != INVALID && twin[prev(last)] == INVALID)
+            f(origin[prev(last)]);
+    }
+
+    unsigned int valence(unsigned int v) const
+    {
+        unsigned int n = 0;
+        forEachNeighbor(v, [&](unsigned int)
+                        { n++; });
+        return n;
+    }
+
+    // Border loops as ordered lists of topological vertices
+    std::vector<std::vector<unsigned int>> borderLoops() const
+    {
+        std::vector<std::vector<unsigned int>> loops;
+        std::vector<bool> visited(origin.size(), false);
+        for (unsigned int h = 0; h < origin.size(); ++h)
+        {
+            if (twin[h] != INVALID || visited[h])
+                continue;
+
+            std::vector<unsigned int> loop;
+            unsigned int e = h;
+            while (!visited[e])
+            {
+                visited[e] = true;
+                loop.push_back(origin[e]);
+
+                // rotate clockwise around the destination until the next border edge
+                unsigned int g = next(e);
+                for (size_t guard = 0; twin[g] != INVALID && guard < origin.size(); ++guard)
+                    g = next(twin[g]);
+                if (twin[g] != INVALID)
+                    break;
+                e = g;
+            }
+            loops.push_back(loop);
+        }
+        return loops;
+    }
+
+    bool isManifold() const { return nonManifoldEdges == 0; }
+
+    // Back to a triangle list over the source vertices
+    std::vector<unsigned int> toIndices() const { return corner; }
+
+    // Triangle list over topological vertices (seams welded away)
+    std::vector<unsigned int> toTopologyIndices() const { return origin; }
+
+private:
+    void buildTopology(const std::vector<unsigned int> &indices, size_t vertexCount)
+    {
+        size_t count = indices.size() - indices.size() % 3;
+        origin.assign(indices.begin(), indices.begin() + count);
+        twin.assign(count, INVALID);
+        nonManifoldEdges = 0;
+
+        std::unordered_map<uint64_t, unsigned int> directed;
+        directed.reserve(count);
+        for (unsigned int h = 0; h < count; ++h)
+        {
+            uint64_t key = ((uint64_t)origin[h] << 32) | origin[next(h)];
+            if (!directed.emplace(key, h).second)
+                nonManifoldEdges++;
+        }
+        for (unsigned int h = 0; h < count; ++h)
+        {
+            if (twin[h] != INVALID || directed.find(((uint64_t)origin[h] << 32) | origin[next(h)])->second != h)
+                continue;
+            auto it = directed.find(((uint64_t)origin[next(h)] << 32) | origin[h]);
+            if (it == directed.end() || it->second == h)
+                continue;
+            twin[h] = it->second;
+            twin[it->second] = h;
+        }
+
+        // prefer border half-edges so one-ring walks start at the border
+        vertexEdge.assign(vertexCount, INVALID);
+        for (unsigned int h = 0; h < count; ++h)
+        {
+            unsigned int v = origin[h];
+            if (vertexEdge[v] == INVALID || twin[h] == INVALID)
+                vertexEdge[v] = h;
+        }
+    }
+};
+
+#endif
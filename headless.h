@@ -0,0 +1,351 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <glad/glad.h>
+
+#ifdef HEADLESS_EGL
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+// Rendering without a window or display: an EGL context on Mesa's surfaceless
+// platform (falling back to a pbuffer on the default display), drawing into an
+// FBO of the requested size. Works with llvmpipe on machines without a GPU.
+// Only available when built with EGL (HEADLESS_EGL); create() fails otherwise.
+class HeadlessContext
+{
+public:
+    int width = 0;
+    int height = 0;
+
+    // Makes a core context of at least major.minor current and binds the FBO;
+    // GL entry points still have to be loaded with getProcAddress()
+    bool create(int w, int h, int major = 3, int minor = 3)
+    {
+        width = w;
+        height = h;
+#ifdef HEADLESS_EGL
+        const char *clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (clientExtensions && std::strstr(clientExtensions, "EGL_MESA_platform_surfaceless") && getPlatformDisplay)
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (display == EGL_NO_DISPLAY)
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr))
+        {
+            std::cerr << "[ERROR] (HEADLESS) no EGL display" << std::endl;
+            return false;
+        }
+        eglBindAPI(EGL_OPENGL_API);
+
+        // the FBO is the real target, the pbuffer only exists if surfaceless contexts don't
+        const EGLint configAttributes[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                                           EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_NONE};
+        EGLConfig config = nullptr;
+        EGLint configCount = 0;
+        if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+        {
+            std::cerr << "[ERROR] (HEADLESS) no EGL config for desktop GL" << std::endl;
+            return false;
+        }
+
+        const EGLint contextAttributes[] = {EGL_CONTEXT_MAJOR_VERSION, major, EGL_CONTEXT_MINOR_VERSION, minor,
+                                            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE};
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+        if (context == EGL_NO_CONTEXT)
+        {
+            std::cerr << "[ERROR] (HEADLESS) could not create a GL " << major << "." << minor << " core context" << std::endl;
+            return false;
+        }
+
+        const char *extensions = eglQueryString(display, EGL_EXTENSIONS);
+        if (!extensions || !std::strstr(extensions, "EGL_KHR_surfaceless_context"))
+        {
+            const EGLint pbufferAttributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+            surface = eglCreatePbufferSurface(display, config, pbufferAttributes);
+        }
+        if (!eglMakeCurrent(display, surface, surface, context))
+        {
+            std::cerr << "[ERROR] (HEADLESS) eglMakeCurrent failed" << std::endl;
+            return false;
+        }
+        return true;
+#else
+        (void)major;
+        (void)minor;
+        std::cerr << "[ERROR] (HEADLESS) built without EGL" << std::endl;
+        return false;
+#endif
+    }
+
+    static void *getProcAddress(const char *name)
+    {
+#ifdef HEADLESS_EGL
+        return (void *)eglGetProcAddress(name);
+#else
+        (void)name;
+        return nullptr;
+#endif
+    }
+
+    // After GL is loaded: color and depth renderbuffers the size of the "window"
+    bool createFramebuffer()
+    {
+        glGenRenderbuffers(2, renderbuffers);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            std::cerr << "[ERROR] (HEADLESS) framebuffer incomplete" << std::endl;
+            return false;
+        }
+        glViewport(0, 0, width, height);
+        std::cout << "[INFO] (HEADLESS) " << width << "x" << height << " offscreen, " << glGetString(GL_RENDERER)
+                  << ", GL " << glGetString(GL_VERSION) << std::endl;
+        return true;
+    }
+
+    // Reads the FBO back (a pipeline stall, only for frames that are saved)
+    bool savePNG(const std::string &path) const
+    {
+        std::vector<unsigned char> pixels((size_t)width * height * 3);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+        return writePNG(path, width, height, pixels, true);
+    }
+
+    void destroy()
+    {
+        if (framebuffer)
+        {
+            glDeleteFramebuffers(1, &framebuffer);
+            glDeleteRenderbuffers(2, renderbuffers);
+            framebuffer = 0;
+        }
+#ifdef HEADLESS_EGL
+        if (display != EGL_NO_DISPLAY)
+        {
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            if (surface != EGL_NO_SURFACE)
+                eglDestroySurface(display, surface);
+            if (context != EGL_NO_CONTEXT)
+                eglDestroyContext(display, context);
+            eglTerminate(display);
+            display = EGL_NO_DISPLAY;
+        }
+#endif
+    }
+
+    // 8-bit RGB PNG with stored (uncompressed) deflate blocks: larger files, no zlib dependency
+    static bool writePNG(const std::string &path, int w, int h, const std::vector<unsigned char> &rgb, bool flipRows)
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cerr << "[ERROR] (HEADLESS) could not write " << path << std::endl;
+            return false;
+        }
+
+        // filter byte 0 before each row; GL rows run bottom-up
+        size_t rowBytes = (size_t)w * 3;
+        std::vector<unsigned char> raw;
+        raw.reserve((rowBytes + 1) * h);
+        for (int y = 0; y < h; ++y)
+        {
+            const unsigned char *row = rgb.data() + rowBytes * (flipRows ? h - 1 - y : y);
+            raw.push_back(0);
+            raw.insert(raw.end(), row, row + rowBytes);
+        }
+
+        std::vector<unsigned char> zlib = {0x78, 0x01};
+        size_t offset = 0;
+        do
+        {
+            size_t length = std::min<size_t>(65535, raw.size() - offset);
+            zlib.push_back(offset + length == raw.size() ? 1 : 0); // BFINAL, stored
+            zlib.push_back((unsigned char)(length & 0xFF));
+            zlib.push_back((unsigned char)(length >> 8));
+            zlib.push_back((unsigned char)(~length & 0xFF));
+            zlib.push_back((unsigned char)((~length >> 8) & 0xFF));
+            zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+            offset += length;
+        } while (offset < raw.size());
+        uint32_t a = 1, b = 0;
+        for (unsigned char c : raw)
+        {
+            a = (a + c) % 65521;
+            b = (b + a) % 65521;
+        }
+        appendBigEndian(zlib, (b << 16) | a);
+
+        std::vector<unsigned char> header;
+        appendBigEndian(header, (uint32_t)w);
+        appendBigEndian(header, (uint32_t)h);
+        header.insert(header.end(), {8, 2, 0, 0, 0}); // 8 bits, truecolor
+
+        static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        file.write(reinterpret_cast<const char *>(signature), 8);
+        writeChunk(file, "IHDR", header);
+        writeChunk(file, "IDAT", zlib);
+        writeChunk(file, "IEND", {});
+        return file.good();
+    }
+
+private:
+    GLuint framebuffer = 0;
+    GLuint renderbuffers[2] = {};
+#ifdef HEADLESS_EGL
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    EGLSurface surface = EGL_NO_SURFACE;
+#endif
+
+    static void appendBigEndian(std::vector<unsigned char> &out, uint32_t value)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+            out.push_back((unsigned char)(value >> shift));
+    }
+
+    static void writeChunk(std::ofstream &file, const char *type, const std::vector<unsigned char> &data)
+    {
+        static uint32_t table[256] = {};
+        if (table[1] == 0)
+        {
+            for (uint32_t n = 0; n < 256; ++n)
+            {
+                uint32_t c = n;
+                for (int k = 0; k < 8; ++k)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                table[n] = c;
+            }
+        }
+
+        std::vector<unsigned char> chunk;
+        appendBigEndian(chunk, (uint32_t)data.size());
+        chunk.insert(chunk.end(), type, type + 4);
+        chunk.insert(chunk.end(), data.begin(), data.end());
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 4; i < chunk.size(); ++i) // over type and data
+            crc = table[(crc ^ chunk[i]) & 0xFF] ^ (crc >> 8);
+        appendBigEndian(chunk, crc ^ 0xFFFFFFFFu);
+        file.write(reinterpret_cast<const char *>(chunk.data()), chunk.size());
+    }
+};
+
+// Per-frame CPU and GPU time. The CPU time covers the frame's work up to its
+// submission, the GPU time comes from one GL_TIME_ELAPSED query per frame.
+// Queries are only read in finish(), so timing never waits on the GPU.
+class FrameTimings
+{
+public:
+    // Creates the run's queries up front, so timing doesn't add a GL object
+    // per frame; frames past the reserved count still get one each
+    void reserve(size_t frames)
+    {
+        size_t created = queries.size();
+        if (frames <= created)
+            return;
+        queries.resize(frames);
+        glGenQueries((GLsizei)(frames - created), queries.data() + created);
+    }
+
+    void beginFrame()
+    {
+        if (used == queries.size())
+        {
+            GLuint query;
+            glGenQueries(1, &query);
+            queries.push_back(query);
+        }
+        glBeginQuery(GL_TIME_ELAPSED, queries[used++]);
+        start = std::chrono::steady_clock::now();
+    }
+
+    void endFrame()
+    {
+        cpuMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+
+    // Collects the GPU times; waits for the last frames to complete
+    void finish()
+    {
+        gpuMs.clear();
+        for (size_t i = 0; i < used; ++i)
+        {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &ns);
+            gpuMs.push_back(ns / 1.0e6);
+        }
+        if (!queries.empty())
+            glDeleteQueries((GLsizei)queries.size(), queries.data());
+        queries.clear();
+        used = 0;
+    }
+
+    // Mean / median / 95th percentile, skipping the first warmup frames
+    void printSummary(size_t warmup) const
+    {
+        std::cout << "[INFO] (HEADLESS) " << cpuMs.size() << " frames, ms (first " << warmup << " skipped)" << std::endl;
+        std::cout << "[INFO] (HEADLESS)         mean    median       p95" << std::endl;
+        printRow("cpu", cpuMs, warmup);
+        printRow("gpu", gpuMs, warmup);
+    }
+
+    bool writeCSV(const std::string &path) const
+    {
+        std::ofstream file(path);
+        if (!file.is_open())
+        {
+            std::cerr << "[ERROR] (HEADLESS) could not write " << path << std::endl;
+            return false;
+        }
+        file << "frame,cpu_ms,gpu_ms\n";
+        for (size_t i = 0; i < cpuMs.size(); ++i)
+            file << i << "," << cpuMs[i] << "," << (i < gpuMs.size() ? gpuMs[i] : 0.0) << "\n";
+        std::cout << "[INFO] (HEADLESS) frame times written to " << path << std::endl;
+        return true;
+    }
+
+private:
+    std::vector<GLuint> queries;
+    size_t used = 0; // queries begun so far
+    std::vector<double> cpuMs, gpuMs;
+    std::chrono::steady_clock::time_point start;
+
+    static void printRow(const char *name, const std::vector<double> &ms, size_t warmup)
+    {
+        if (ms.size() <= warmup)
+            return;
+        std::vector<double> sorted(ms.begin() + warmup, ms.end());
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (double v : sorted)
+            sum += v;
+        std::cout << "[INFO] (HEADLESS) " << name << std::fixed << std::setprecision(3) << std::setw(10) << sum / sorted.size()
+                  << std::setw(10) << sorted[sorted.size() / 2] << std::setw(10) << sorted[(sorted.size() * 95) / 100]
+                  << std::defaultfloat << std::endl;
+    }
+};
+
+#endif
@@ -0,0 +1,231 @@
+#ifndef INPUT_TRACE_H
+#define INPUT_TRACE_H
+
+#include <GLFW/glfw3.h>
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// One input event at a loop time in seconds
+struct InputEvent
+{
+    enum Type : uint8_t
+    {
+        KEY,    // code = key, action = GLFW_PRESS / GLFW_RELEASE
+        CURSOR, // x, y in window coordinates
+        BUTTON, // code = mouse button, action, x = mods
+        SCROLL, // x, y offsets
+    };
+
+    float time;
+    Type type;
+    uint8_t action;
+    uint16_t code;
+    float x, y;
+};
+
+// Records the app's input with timestamps, or plays a recording back instead
+// of the live input. Keys are polled, so a key event is logged when a polled
+// state changes; mouse events come from the GLFW callbacks, which run in
+// glfwPollEvents at the end of a frame and take effect in the next one, so they
+// are stamped with the time of the poll (after this frame's, at or before the
+// next frame's) and replayed at the start of the next frame. Replays run on a
+// fixed-step clock and deliver each event on the first frame at or after its
+// time, so every replay of a file does exactly the same work.
+//
+// File: "SGIN", version, event count, duration, then 16 bytes per event
+// (little endian).
+class InputTrace
+{
+public:
+    enum Mode
+    {
+        LIVE,
+        RECORDING,
+        REPLAYING,
+    };
+
+    Mode getMode() const { return mode; }
+    bool replaying() const { return mode == REPLAYING; }
+
+    void startRecording(const std::string &filePath)
+    {
+        mode = RECORDING;
+        path = filePath;
+        events.clear();
+    }
+
+    bool load(const std::string &filePath)
+    {
+        std::ifstream file(filePath, std::ios::binary);
+        char magic[4];
+        uint32_t version = 0, count = 0;
+        if (!file.read(magic, 4) || std::memcmp(magic, "SGIN", 4) != 0 ||
+            !file.read(reinterpret_cast<char *>(&version), 4) || version != VERSION ||
+            !file.read(reinterpret_cast<char *>(&count), 4) || !file.read(reinterpret_cast<char *>(&duration), 4))
+        {
+            std::cerr << "[ERROR] (INPUT) " << filePath << " is not an input recording" << std::endl;
+            return false;
+        }
+        events.resize(count);
+        for (InputEvent &e : events)
+        {
+            file.read(reinterpret_cast<char *>(&e.time), 4);
+            file.read(reinterpret_cast<char *>(&e.type), 1);
+            file.read(reinterpret_cast<char *>(&e.action), 1);
+            file.read(reinterpret_cast<char *>(&e.code), 2);
+            file.read(reinterpret_cast<char *>(&e.x), 4);
+            file.read(reinterpret_cast<char *>(&e.y), 4);
+        }
+        if (!file)
+        {
+            std::cerr << "[ERROR] (INPUT) " << filePath << " is truncated" << std::endl;
+            return false;
+        }
+        mode = REPLAYING;
+        next = 0;
+        time = 0.0f;
+        std::cout << "[INFO] (INPUT) replaying " << count << " events, " << duration << " s" << std::endl;
+        return true;
+    }
+
+    // Writes the recording; call once the loop has ended
+    bool save() const
+    {
+        if (mode != RECORDING)
+            return true;
+        std::ofstream file(path, std::ios::binary);
+        uint32_t version = VERSION, count = (uint32_t)events.size();
+        file.write("SGIN", 4);
+        file.write(reinterpret_cast<const char *>(&version), 4);
+        file.write(reinterpret_cast<const char *>(&count), 4);
+        file.write(reinterpret_cast<const char *>(&time), 4); // the last frame's time
+        for (const InputEvent &e : events)
+        {
+            file.write(reinterpret_cast<const char *>(&e.time), 4);
+            file.write(reinterpret_cast<const char *>(&e.type), 1);
+            file.write(reinterpret_cast<const char *>(&e.action), 1);
+            file.write(reinterpret_cast<const char *>(&e.code), 2);
+            file.write(reinterpret_cast<const char *>(&e.x), 4);
+            file.write(reinterpret_cast<const char *>(&e.y), 4);
+        }
+        if (!file)
+        {
+            std::cerr << "[ERROR] (INPUT) could not write " << path << std::endl;
+            return false;
+        }
+        std::cout << "[INFO] (INPUT) recorded " << count << " events to " << path << std::endl;
+        return true;
+    }
+
+    // Loop time for the events logged from now on; replays keep their own
+    void setTime(double seconds)
+    {
+        if (mode != REPLAYING)
+            time = (float)seconds;
+    }
+
+    // Drop-in for glfwGetKey
+    int key(GLFWwindow *window, int code)
+    {
+        if (code < 0 || code > GLFW_KEY_LAST)
+            return GLFW_RELEASE;
+        if (mode == REPLAYING)
+            return keys[code];
+
+        int state = glfwGetKey(window, code);
+        if (mode == RECORDING && state != keys[code])
+            events.push_back({time, InputEvent::KEY, (uint8_t)state, (uint16_t)code, 0.0f, 0.0f});
+        keys[code] = (uint8_t)state;
+        return state;
+    }
+
+    // Called first in the GLFW callbacks: false means ignore the live event
+    // because a recording is playing
+    bool cursor(double x, double y)
+    {
+        return live({time, InputEvent::CURSOR, 0, 0, (float)x, (float)y});
+    }
+    bool button(int button, int action, int mods)
+    {
+        return live({time, InputEvent::BUTTON, (uint8_t)action, (uint16_t)button, (float)mods, 0.0f});
+    }
+    bool scroll(double x, double y)
+    {
+        return live({time, InputEvent::SCROLL, 0, 0, (float)x, (float)y});
+    }
+
+    // Drop-in for glfwGetCursorPos
+    void cursorPos(GLFWwindow *window, double *x, double *y) const
+    {
+        if (mode == REPLAYING)
+        {
+            *x = cursorX;
+            *y = cursorY;
+            return;
+        }
+        glfwGetCursorPos(window, x, y);
+    }
+
+    // Applies the recorded events up to now: keys change the polled state,
+    // the others go to dispatch(event), which should call the app's callbacks
+    template <typename F>
+    void replay(double now, F dispatch)
+    {
+        if (mode != REPLAYING)
+            return;
+        time = (float)now;
+        dispatching = true;
+        for (; next < events.size() && events[next].time <= now; ++next)
+        {
+            const InputEvent &e = events[next];
+            if (e.type == InputEvent::KEY)
+            {
+                if (e.code <= GLFW_KEY_LAST)
+                    keys[e.code] = e.action;
+                continue;
+            }
+            if (e.type == InputEvent::CURSOR)
+            {
+                cursorX = e.x;
+                cursorY = e.y;
+            }
+            dispatch(e);
+        }
+        dispatching = false;
+    }
+
+    // Length of the loaded recording in seconds
+    float length() const { return duration; }
+
+    // All events delivered and the recorded run's length reached
+    bool finished() const { return mode == REPLAYING && next >= events.size() && time >= duration; }
+
+private:
+    static constexpr uint32_t VERSION = 1;
+
+    Mode mode = LIVE;
+    std::string path;
+    std::vector<InputEvent> events;
+    size_t next = 0; // next event to replay
+    float time = 0.0f;     // current loop time
+    float duration = 0.0f; // of the recording
+    uint8_t keys[GLFW_KEY_LAST + 1] = {};
+    double cursorX = 0.0, cursorY = 0.0;
+    bool dispatching = false;
+
+    bool live(const InputEvent &e)
+    {
+        if (mode == REPLAYING)
+            return dispatching;
+        if (mode == RECORDING)
+            events.push_back(e);
+        return true;
+    }
+};
+
+#endif
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <algorithm>
 #include "bezier/bezier1.h"
 #include "camera.h"
 #include "mesh.h"
@@ -13,6 +14,22 @@
 #include "shader.h"
 #include "animator.h"
 #include "primitives.h"
+#include "occlusion.h"
+#include "render_queue.h"
+#include "simplify.h"
+#include "tessellation.h"
+#include "meshlet.h"
+#include "stream_buffer.h"
+#include "curve_patch.h"
+#include "headless.h"
+#include "input_trace.h"
+#include "camera_path.h"
+#include "profiler.h"
+#include "gpu_profiler.h"
+#include "render_stats.h"
+#include "text_overlay.h"
+#include <memory>
+#include <cstring>
 
 const glm::vec3 COLOR_RED = glm::vec3(204.0f / 255.0f, 50.0f / 255.0f, 6.0f / 255.0f);
 const glm::vec3 COLOR_YELLOW = glm::vec3(204.0f / 255.0f, 190.0f / 255.0f, 2.0f / 255.0f);
@@ -26,6 +43,17 @@ struct SceneObject
 {
     Mesh mesh;
     glm::mat4 transform;
+    bool occluder = false; // rasterized into the occlusion buffer
+    LodChain lods;         // simplified versions, empty for most objects
+    bool procedural = false;
+    PrimitiveDesc primitive{}; // analytic shape when procedural, tessellated per distance
+    Mesh *lodMesh = nullptr;   // picked each frame, null draws the full mesh
+    MeshletSet meshlets;       // clusters of the full mesh, empty for small objects
+    std::vector<GLsizei> clusterCounts;        // visible cluster ranges this frame,
+    std::vector<const void *> clusterOffsets; // empty draws the whole mesh
+    int patch = -1;                            // curvePatches entry drawn instead while tessellating
+
+    Mesh &drawMesh() { return lodMesh ? *lodMesh : mesh; }
 };
 
 // Animation data structures
@@ -55,13 +83,31 @@ void scroll_callback(GLFWwindow *window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
 void createParkScene(std::vector<SceneObject> &objects);
 void updateAnimations(std::vector<SceneObject> &objects, float time);
+void setFrameUniforms(Shader &shader, const glm::mat4 &projection, const glm::mat4 &view);
+SceneObject makePrimitiveObject(const PrimitiveDesc &desc, const glm::mat4 &transform, bool occluder = false);
 
 const unsigned int SCR_WIDTH = 1024;
 const unsigned int SCR_HEIGHT = 768;
 
-bool drawEdges = false;
+// B cycles through the edge display modes
+enum EdgeMode
+{
+    EDGES_OFF,
+    EDGES_LINES,     // second GL_LINES draw per object from the edge EBO
+    EDGES_WIREFRAME, // barycentric overlay in the main pass, no extra draws
+};
+EdgeMode edgeMode = EDGES_OFF;
 bool lightingEnabled = true;
 bool animationsEnabled = true;
+bool occlusionCullingEnabled = true;
+bool lodEnabled = true;
+const float LOD_PIXEL_ERROR = 1.0f; // max simplification/tessellation error on screen
+TessellationCache tessellationCache;
+int subdivisionLevels = 0; // applied to models loaded with O
+const int MAX_SUBDIVISION_LEVELS = 3;
+const size_t SMALL_PART_TRIANGLES = 16; // loaded parts below this share one batch mesh
+bool clusterCullingEnabled = true;
+MeshletStats meshletStats;
 
 // camera
 Camera camera(glm::vec3(0.0f, 15.0f, 30.0f));
@@ -93,10 +139,176 @@ std::vector<SwingData> swings;
 MerryGoRoundData merryGoRound;
 PositionAnimator bezierAnimator; // For smooth bezier editing
 
+// Occlusion culling
+OcclusionCuller occlusionCuller;
+
+// Per-frame geometry (the slide while editing) goes through a fenced ring
+StreamBuffer streamBuffer;
+const size_t STREAM_FRAME_BYTES = 256 * 1024;
+std::vector<Vertex> slideVertices;
+std::vector<unsigned int> slideIndices, slideStripIndices;
+
+// Curve assets (slide, revolved surfaces) as tessellated patches, GL 4.0+
+std::vector<CurvePatch> curvePatches;
+bool tessellationEnabled = false;
+const float PATCH_PIXELS_PER_SEGMENT = 8.0f;
+
+// Sorted draw submission
+RenderQueue renderQueue;
+RenderState renderState;
+const unsigned int PROGRAM_SCENE = 0; // slots in the program table below
+const unsigned int PROGRAM_WIREFRAME = 1;
+const unsigned int PROGRAM_PATCH = 2;
+// GPU profiler labels: a scope per pass and per program batch inside it
+const char *PASS_NAMES[] = {"opaquePass", "edgePass"};
+const char *BATCH_NAMES[][3] = {{"opaque scene", "opaque wireframe", "opaque patches"},
+                                {"edges scene", "edges wireframe", "edges patches"}};
+const float FAR_PLANE = 100.0f;
+float lastStatsTime = 0.0f;
+
+// Command line: --headless renders offscreen with a scripted camera,
+// --record / --replay capture and play back the input
+struct RunOptions
+{
+    bool headless = false;
+    int frames = 300;
+    std::string pngDirectory; // empty: no images
+    int pngEvery = 30;
+    std::string statsPath;  // per-frame CSV, empty: summary only
+    std::string recordPath; // input recording to write
+    std::string replayPath; // input recording to play back
+    std::string cameraPath; // keyframes instead of CAMERA_PATH_FILE / the park tour
+    bool profile = false;   // per-phase CPU stats
+    std::string tracePath;  // Chrome trace JSON
+    long long traceFirst = 0, traceCount = 0; // frames to trace, count 0: to the end
+    std::string renderStatsPath; // per-frame renderer counters CSV
+    bool overlay = false;        // renderer counters drawn over the frame
+};
+
+// headless and replayed runs advance this much per frame, whatever the real frame time
+const double FIXED_TIMESTEP = 1.0 / 60.0;
+
+// Live or recorded input; processInput and the callbacks go through it
+InputTrace inputTrace;
+
+// Camera flythrough: N adds the current view as a keyframe, V plays the route
+CameraPath cameraPath;
+bool cameraPathPlaying = false;
+float cameraPathDistance = 0.0f;
+const float CAMERA_PATH_SPEED = 5.0f; // units per second
+const char *CAMERA_PATH_FILE = "../camera.path";
+
+// CPU profiler: I shows the per-phase stats, J traces the next frames
+const float PROFILE_PRINT_INTERVAL = 2.0f; // seconds between stats printouts
+const long long TRACE_FRAMES = 120;
+const char *TRACE_FILE = "../trace.json";
+bool profileStats = false; // print the stats while running
+float lastProfilePrintTime = 0.0f;
+
+// Renderer counters: H shows them over the frame
+bool statsOverlay = false;
+
+bool parseOptions(int argc, char **argv, RunOptions &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--headless") == 0)
+            options.headless = true;
+        else if (std::strcmp(argv[i], "--frames") == 0 && hasValue)
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--png") == 0 && hasValue)
+            options.pngDirectory = argv[++i];
+        else if (std::strcmp(argv[i], "--png-every") == 0 && hasValue)
+            options.pngEvery = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--stats") == 0 && hasValue)
+            options.statsPath = argv[++i];
+        else if (std::strcmp(argv[i], "--record") == 0 && hasValue)
+            options.recordPath = argv[++i];
+        else if (std::strcmp(argv[i], "--replay") == 0 && hasValue)
+            options.replayPath = argv[++i];
+        else if (std::strcmp(argv[i], "--camera-path") == 0 && hasValue)
+            options.cameraPath = argv[++i];
+        else if (std::strcmp(argv[i], "--profile") == 0)
+            options.profile = true;
+        else if (std::strcmp(argv[i], "--trace") == 0 && hasValue)
+            options.tracePath = argv[++i];
+        else if (std::strcmp(argv[i], "--render-stats") == 0 && hasValue)
+            options.renderStatsPath = argv[++i];
+        else if (std::strcmp(argv[i], "--overlay") == 0)
+            options.overlay = true;
+        else if (std::strcmp(argv[i], "--trace-frames") == 0 && hasValue)
+        {
+            long long first = 0, last = 0;
+            if (std::sscanf(argv[++i], "%lld-%lld", &first, &last) != 2 || first < 0 || last < first)
+            {
+                std::cout << "--trace-frames takes FIRST-LAST, e.g. 100-159" << std::endl;
+                return false;
+            }
+            options.traceFirst = first;
+            options.traceCount = last - first + 1;
+        }
+        else
+        {
+            std::cout << "Usage: SceneGL [--record FILE | --replay FILE] [--camera-path FILE] [--profile] "
+                         "[--trace FILE.json [--trace-frames FIRST-LAST]] [--render-stats FILE.csv] [--overlay] [--headless [--frames N] "
+                         "[--png DIR] [--png-every K] [--stats FILE.csv]]"
+                      << std::endl;
+            return false;
+        }
+    }
+    if (!options.recordPath.empty() && (options.headless || !options.replayPath.empty()))
+    {
+        std::cout << "--record needs live input, it can't be combined with --headless or --replay" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Window size for picking; headless runs have no window
+void framebufferSize(int &width, int &height)
+{
+    width = SCR_WIDTH;
+    height = SCR_HEIGHT;
+    if (g_window)
+        glfwGetFramebufferSize(g_window, &width, &height);
+}
+
+// Hands a replayed mouse event to the callback GLFW would have called
+void dispatchInputEvent(GLFWwindow *window, const InputEvent &e)
+{
+    if (e.type == InputEvent::CURSOR)
+        mouse_callback(window, e.x, e.y);
+    else if (e.type == InputEvent::BUTTON)
+        mouse_button_callback(window, e.code, e.action, (int)e.x);
+    else if (e.type == InputEvent::SCROLL)
+        scroll_callback(window, e.x, e.y);
+}
+
+// Default route when there is no recorded path: overview, slide,
+// merry-go-round, swings and back to the start
+void buildParkTour(CameraPath &path)
+{
+    const glm::vec3 stops[][2] = {
+        {{0.0f, 10.0f, 26.0f}, {0.0f, 1.5f, 0.0f}},
+        {{-2.0f, 4.0f, 14.0f}, {-3.0f, 2.5f, 5.0f}},
+        {{-15.0f, 3.0f, 2.0f}, {-8.0f, 0.5f, -8.0f}},
+        {{-2.0f, 3.0f, -15.0f}, {5.0f, 2.0f, -5.0f}},
+        {{13.0f, 5.0f, 5.0f}, {0.0f, 1.5f, 0.0f}},
+        {{0.0f, 10.0f, 26.0f}, {0.0f, 1.5f, 0.0f}},
+    };
+    path.clear();
+    for (const auto &stop : stops)
+    {
+        glm::vec3 direction = glm::normalize(stop[1] - stop[0]);
+        path.addKeyframe(stop[0], glm::degrees(atan2(direction.z, direction.x)), glm::degrees(asin(direction.y)));
+    }
+}
+
 glm::vec3 screenToWorld(double xpos, double ypos, const glm::mat4 &view, const glm::mat4 &projection)
 {
     int width, height;
-    glfwGetFramebufferSize(g_window, &width, &height);
+    framebufferSize(width, height);
 
     float x = (2.0f * (float)xpos) / (float)width - 1.0f;
     float y = 1.0f - (2.0f * (float)ypos) / (float)height;
@@ -126,6 +338,19 @@ int getSlidePointIndexAt(glm::vec3 worldPos)
     return -1;
 }
 
+// Leaving edit mode: the slide's ring data is only valid for the frame that
+// wrote it, so the last streamed shape goes back into static buffers
+void freezeSlide()
+{
+    if (!g_sceneObjects || slideObjectIndex < 0 || slideVertices.empty())
+        return;
+    Mesh &mesh = (*g_sceneObjects)[slideObjectIndex].mesh;
+    if (!mesh.isStreamed())
+        return;
+    mesh.release();
+    mesh = Mesh(slideVertices, slideIndices, slideStripIndices);
+}
+
 void updateAnimations(std::vector<SceneObject> &objects, float time)
 {
     if (!animationsEnabled)
@@ -193,59 +418,183 @@ void updateAnimations(std::vector<SceneObject> &objects, float time)
     }
 }
 
-int main()
+int main(int argc, char **argv)
 {
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    RunOptions options;
+    if (!parseOptions(argc, argv, options))
+        return -1;
 
-    GLFWwindow *window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Animated Playground", NULL, NULL);
-    if (window == NULL)
+    // on before loading, so the scene and model builders show up too
+    Profiler &profiler = Profiler::instance();
+    profileStats = options.profile;
+    if (options.profile)
+        profiler.setEnabled(true);
+    if (!options.tracePath.empty())
+        profiler.captureTrace(options.tracePath, options.traceFirst, options.traceCount);
+
+    // headless runs never touch GLFW, there may be no display at all
+    GLFWwindow *window = nullptr;
+    HeadlessContext headlessContext;
+    if (options.headless)
     {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
+        if (!headlessContext.create(SCR_WIDTH, SCR_HEIGHT))
+            return -1;
     }
+    else
+    {
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-    g_window = window;
+        window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Animated Playground", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
 
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetCursorPosCallback(window, mouse_callback);
-    glfwSetMouseButtonCallback(window, mouse_button_callback);
-    glfwSetScrollCallback(window, scroll_callback);
+        g_window = window;
 
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetCursorPosCallback(window, mouse_callback);
+        glfwSetMouseButtonCallback(window, mouse_button_callback);
+        glfwSetScrollCallback(window, scroll_callback);
 
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    }
+
+    if (!gladLoadGLLoader(options.headless ? (GLADloadproc)HeadlessContext::getProcAddress : (GLADloadproc)glfwGetProcAddress))
     {
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    // before any GL object exists, so the live counts start from zero
+    RenderStats &renderStats = RenderStats::instance();
+    renderStats.install();
+    if (!options.renderStatsPath.empty() && !renderStats.openDump(options.renderStatsPath))
+        return -1;
+    statsOverlay = options.overlay;
+    if (options.headless && !headlessContext.createFramebuffer())
+        return -1;
 
     glEnable(GL_DEPTH_TEST);
+    Mesh::enablePrimitiveRestart();
+    streamBuffer.create(STREAM_FRAME_BYTES);
+    TextOverlay textOverlay;
+    textOverlay.create();
+    GpuProfiler &gpuProfiler = GpuProfiler::instance();
+    gpuProfiler.create();
 
     Shader shader("shader.vert", "shader.frag");
+    Shader wireframeShader("shader.vert", "shader.frag", "wireframe.geom", "#define WIREFRAME");
+
+    std::unique_ptr<Shader> patchShader;
+    if (CurvePatch::supported())
+        patchShader.reset(new Shader("patch.vert", "shader.frag", ShaderTessellation{"patch.tess", "patch.tess"}));
+
+    // program table indexed by the program field of the draw keys
+    std::vector<Shader *> programs = {&shader, &wireframeShader, patchShader.get()};
+
+    // 16-byte packed vertices on the GPU, the float copies stay on the CPU
+    Mesh::compressVertices = true;
 
     std::vector<SceneObject> sceneObjects;
     g_sceneObjects = &sceneObjects;
     createParkScene(sceneObjects);
+    if (CurvePatch::supported() && slideObjectIndex >= 0)
+    {
+        sceneObjects[slideObjectIndex].patch = (int)curvePatches.size();
+        curvePatches.push_back(CurvePatch::slide(slideCurve.controlPoints, slideWidth, 0.3f, COLOR_RED));
+    }
 
-    std::cout << "Controls:" << std::endl;
-    std::cout << "  TAB - Toggle edit mode" << std::endl;
-    std::cout << "  P - Toggle animations" << std::endl;
-    std::cout << "  L - Toggle lighting" << std::endl;
-    std::cout << "  B - Toggle edges" << std::endl;
+    if (!options.headless)
+    {
+        std::cout << "Controls:" << std::endl;
+        std::cout << "  TAB - Toggle edit mode" << std::endl;
+        std::cout << "  P - Toggle animations" << std::endl;
+        std::cout << "  L - Toggle lighting" << std::endl;
+        std::cout << "  B - Cycle edges (off / lines / wireframe)" << std::endl;
+        std::cout << "  F - Toggle feature-only edge lines" << std::endl;
+        std::cout << "  C - Toggle occlusion culling" << std::endl;
+        std::cout << "  K - Toggle per-cluster culling of loaded models" << std::endl;
+        std::cout << "  M - Toggle LOD (loaded models and procedural primitives)" << std::endl;
+        std::cout << "  T - Toggle tessellated curve patches (slide, revolved surfaces; GL 4.0+)" << std::endl;
+        std::cout << "  N - Add the current view to the camera path (X clears it)" << std::endl;
+        std::cout << "  V - Play / stop the camera path" << std::endl;
+        std::cout << "  I - Toggle the CPU profiler (per-phase stats every " << PROFILE_PRINT_INTERVAL << " s)" << std::endl;
+        std::cout << "  J - Trace the next " << TRACE_FRAMES << " frames to " << TRACE_FILE << std::endl;
+        std::cout << "  H - Toggle the renderer stats overlay (draws, uploads, live GL objects)" << std::endl;
+    }
+
+    if (!options.recordPath.empty())
+        inputTrace.startRecording(options.recordPath);
+    if (!options.replayPath.empty() && !inputTrace.load(options.replayPath))
+        return -1;
+
+    if (!options.cameraPath.empty())
+    {
+        if (!cameraPath.load(options.cameraPath) || !cameraPath.playable())
+        {
+            std::cout << "[ERROR] " << options.cameraPath << " is not a camera path with two or more keyframes" << std::endl;
+            return -1;
+        }
+    }
+    else if (!cameraPath.load(CAMERA_PATH_FILE) || !cameraPath.playable())
+    {
+        buildParkTour(cameraPath);
+    }
 
-    while (!glfwWindowShouldClose(window))
+    // wall-clock time only when someone is at the controls
+    SystemClock systemClock;
+    FixedStepClock fixedClock(FIXED_TIMESTEP);
+    const Clock &clock = (options.headless || inputTrace.replaying()) ? (const Clock &)fixedClock : systemClock;
+    bezierAnimator.setClock(clock);
+
+    // replays run until the recording ends, headless runs for --frames otherwise
+    auto running = [&](int frame)
+    {
+        if (inputTrace.replaying())
+            return !inputTrace.finished() && (!window || !glfwWindowShouldClose(window));
+        return options.headless ? frame < options.frames : !glfwWindowShouldClose(window);
+    };
+
+    FrameTimings frameTimings;
+    if (options.headless)
+        frameTimings.reserve(inputTrace.replaying() ? (size_t)std::ceil(inputTrace.length() / FIXED_TIMESTEP) + 1 : (size_t)options.frames);
+    int frame = 0;
+    for (; running(frame); ++frame)
     {
-        float currentFrame = static_cast<float>(glfwGetTime());
+        float currentFrame = static_cast<float>(clock.now());
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
-        processInput(window);
+        if (options.headless)
+            frameTimings.beginFrame();
+        profiler.beginFrame();
+        gpuProfiler.beginFrame();
+        inputTrace.setTime(currentFrame);
+        inputTrace.replay(currentFrame, [&](const InputEvent &e)
+                          { dispatchInputEvent(window, e); });
+        if (options.headless && !inputTrace.replaying())
+        {
+            // the whole route once over the run
+            cameraPath.apply(camera, cameraPath.length() * frame / std::max(1, options.frames - 1));
+        }
+        else
+        {
+            PROFILE_SCOPE("processInput");
+            processInput(window);
+            if (cameraPathPlaying && cameraPath.playable())
+            {
+                cameraPathDistance = std::fmod(cameraPathDistance + CAMERA_PATH_SPEED * deltaTime, cameraPath.length());
+                cameraPath.apply(camera, cameraPathDistance);
+            }
+        }
 
+        ProfileScope animationScope("updateAnimations");
         // Update bezier animation if active
         if (bezierAnimator.isAnimating())
         {
@@ -254,49 +603,193 @@ int main()
 
         // Update playground animations
         updateAnimations(sceneObjects, currentFrame);
+        animationScope.stop();
 
-        glClearColor(0.53f, 0.80f, 0.91f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        {
+            PROFILE_SCOPE("clear");
+            GPU_PROFILE_SCOPE("clear");
+            glClearColor(0.53f, 0.80f, 0.91f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
 
         shader.use();
 
-        int width, height;
-        glfwGetFramebufferSize(window, &width, &height);
-        glm::mat4 projection = glm::perspective(glm::radians(camera.zoom), (float)width / (float)height, 0.1f, 100.0f);
+        int width = headlessContext.width, height = headlessContext.height;
+        if (window)
+            glfwGetFramebufferSize(window, &width, &height);
+        glm::mat4 projection = glm::perspective(glm::radians(camera.zoom), (float)width / (float)height, 0.1f, FAR_PLANE);
         glm::mat4 view = camera.getViewMatrix();
 
-        shader.setMat4("projection", projection);
-        shader.setMat4("view", view);
-        shader.setBool("lightingEnabled", lightingEnabled);
-        shader.setFloat("ambientStrength", 0.3f);
-        shader.setFloat("lightStrength", 0.8f);
-        shader.setFloat("shininess", 25.0f);
-        shader.setVec3("lightPos", glm::vec3(50.0f, 100.0f, 50.0f));
-        shader.setVec3("viewPos", camera.position);
+        ProfileScope uniformScope("frameUniforms");
+        if (edgeMode == EDGES_WIREFRAME)
+        {
+            wireframeShader.use();
+            setFrameUniforms(wireframeShader, projection, view);
+            wireframeShader.setVec3("wireframeColor", glm::vec3(0.0f));
+            wireframeShader.setFloat("wireframeWidth", 1.5f);
+            shader.use();
+        }
+        if (tessellationEnabled)
+        {
+            patchShader->use();
+            setFrameUniforms(*patchShader, projection, view);
+            patchShader->setVec2("viewportSize", glm::vec2((float)width, (float)height));
+            patchShader->setFloat("pixelsPerSegment", PATCH_PIXELS_PER_SEGMENT);
+            shader.use();
+        }
+        setFrameUniforms(shader, projection, view);
+        uniformScope.stop();
 
         // Regenerate slide mesh if in edit mode
         if (editMode && slideObjectIndex >= 0 && slideCurve.controlPoints.size() >= 2)
         {
-            Mesh newSlideMesh = slideCurve.createSlideExtrusion(slideWidth, 0.3f, 20, COLOR_RED);
-            sceneObjects[slideObjectIndex].mesh = newSlideMesh;
+            PROFILE_SCOPE("slideRebuild");
+            slideCurve.buildSlideExtrusion(slideWidth, 0.3f, 20, COLOR_RED, true, slideVertices, slideIndices, slideStripIndices);
+            sceneObjects[slideObjectIndex].mesh.stream(streamBuffer, slideVertices, slideIndices, slideStripIndices);
+            if (sceneObjects[slideObjectIndex].patch >= 0)
+                curvePatches[sceneObjects[slideObjectIndex].patch].setControlPoints(slideCurve.controlPoints);
         }
 
-        // Render scene objects
-        for (auto &obj : sceneObjects)
+        // Rasterize the big occluders into the coarse depth buffer
+        if (occlusionCullingEnabled)
         {
-            shader.setMat4("model", obj.transform);
-            obj.mesh.draw(shader);
-            if (drawEdges)
-                obj.mesh.drawEdges(shader);
+            PROFILE_SCOPE("occluders");
+            occlusionCuller.beginFrame(projection * view);
+            for (auto &obj : sceneObjects)
+            {
+                if (obj.occluder)
+                    occlusionCuller.addOccluder(obj.mesh, obj.transform);
+            }
         }
 
+        // world units -> pixels at distance 1, for screen-space LOD error
+        float pixelsPerUnit = (float)height / (2.0f * tan(glm::radians(camera.zoom) * 0.5f));
+
+        // Queue visible scene objects, keyed by pass, program, depth and geometry
+        ProfileScope queueScope("buildQueue");
+        renderQueue.clear();
+        meshletStats = MeshletStats();
+        std::vector<bool> patchQueued(curvePatches.size(), false);
+        for (size_t i = 0; i < sceneObjects.size(); ++i)
+        {
+            SceneObject &obj = sceneObjects[i];
+            if (occlusionCullingEnabled && !occlusionCuller.isVisible(obj.mesh.boundsMin, obj.mesh.boundsMax, obj.transform))
+                continue;
+
+            glm::vec3 center = glm::vec3(obj.transform * glm::vec4((obj.mesh.boundsMin + obj.mesh.boundsMax) * 0.5f, 1.0f));
+            float distance = glm::length(center - camera.position);
+            float depth = distance / FAR_PLANE;
+
+            // the parts of a loaded surface share one patch, queued once
+            if (tessellationEnabled && obj.patch >= 0 && curvePatches[obj.patch].drawable())
+            {
+                if (!patchQueued[obj.patch])
+                    renderQueue.push(RenderQueue::makeKey(PASS_OPAQUE, PROGRAM_PATCH, curvePatches[obj.patch].VAO, depth), (uint32_t)i);
+                patchQueued[obj.patch] = true;
+                continue;
+            }
+
+            obj.lodMesh = nullptr;
+            if (lodEnabled && (obj.procedural || !obj.lods.levels.empty()))
+            {
+                float scale = std::max({glm::length(glm::vec3(obj.transform[0])),
+                                        glm::length(glm::vec3(obj.transform[1])),
+                                        glm::length(glm::vec3(obj.transform[2]))});
+                float objectPixelsPerUnit = pixelsPerUnit * scale / std::max(distance, 0.1f);
+                if (obj.procedural)
+                {
+                    int level = tessellationCache.select(obj.primitive, objectPixelsPerUnit, LOD_PIXEL_ERROR);
+                    obj.lodMesh = &tessellationCache.get(obj.primitive, level);
+                }
+                else
+                {
+                    int level = obj.lods.select(objectPixelsPerUnit, LOD_PIXEL_ERROR);
+                    if (level >= 0)
+                        obj.lodMesh = &obj.lods.levels[level];
+                }
+            }
+
+            // full-detail clustered meshes only submit their visible clusters
+            obj.clusterCounts.clear();
+            obj.clusterOffsets.clear();
+            if (clusterCullingEnabled && !obj.lodMesh && !obj.meshlets.empty())
+            {
+                obj.meshlets.cull(projection * view, obj.transform, camera.position, obj.mesh.indexType,
+                                  obj.clusterCounts, obj.clusterOffsets, meshletStats);
+                if (obj.clusterCounts.empty())
+                    continue;
+            }
+            GLuint vao = obj.drawMesh().VAO;
+
+            unsigned int program = (edgeMode == EDGES_WIREFRAME) ? PROGRAM_WIREFRAME : PROGRAM_SCENE;
+            renderQueue.push(RenderQueue::makeKey(PASS_OPAQUE, program, vao, depth), (uint32_t)i);
+            if (edgeMode == EDGES_LINES)
+                renderQueue.push(RenderQueue::makeKey(PASS_EDGES, PROGRAM_SCENE, vao, depth), (uint32_t)i);
+        }
+        renderQueue.sort();
+        queueScope.stop();
+
+        // Submit in key order, only touching GL state when it changes
+        ProfileScope submitScope("submitDraws");
+        renderState.reset();
+        int passScope = -1, batchScope = -1;
+        int currentPass = -1, currentProgram = -1;
+        for (const DrawItem &item : renderQueue.getItems())
+        {
+            SceneObject &obj = sceneObjects[item.payload];
+            Mesh &mesh = obj.drawMesh();
+            Shader &program = *programs[RenderQueue::keyProgram(item.key)];
+
+            // the queue is sorted by pass, then program, so batches are contiguous
+            int pass = (int)RenderQueue::keyPass(item.key), programIndex = (int)RenderQueue::keyProgram(item.key);
+            if (pass != currentPass || programIndex != currentProgram)
+            {
+                gpuProfiler.end(batchScope);
+                if (pass != currentPass)
+                {
+                    gpuProfiler.end(passScope);
+                    passScope = gpuProfiler.begin(PASS_NAMES[pass]);
+                }
+                batchScope = gpuProfiler.begin(BATCH_NAMES[pass][programIndex]);
+                currentPass = pass;
+                currentProgram = programIndex;
+            }
+
+            renderState.useProgram(program.id);
+            if (RenderQueue::keyProgram(item.key) == PROGRAM_PATCH)
+            {
+                CurvePatch &patch = curvePatches[obj.patch];
+                program.setMat4("model", obj.transform);
+                patch.draw(program, streamBuffer);
+                renderState.bindVertexArray(patch.VAO); // draw() left it bound
+                continue;
+            }
+            renderState.bindVertexArray(mesh.VAO);
+            program.setMat4("model", obj.transform);
+            mesh.setVertexUniforms(program);
+
+            if (RenderQueue::keyPass(item.key) == PASS_EDGES)
+                mesh.drawEdgeElements();
+            else if (!obj.clusterCounts.empty())
+                mesh.drawRanges(obj.clusterCounts, obj.clusterOffsets);
+            else
+                mesh.drawElements();
+        }
+        gpuProfiler.end(batchScope);
+        gpuProfiler.end(passScope);
+        renderState.bindVertexArray(0);
+        shader.use();
+        submitScope.stop();
+
         // Render control point spheres in edit mode
         if (editMode)
         {
+            PROFILE_SCOPE("controlPoints");
+            GPU_PROFILE_SCOPE("controlPoints");
             for (size_t i = 0; i < slideCurve.controlPoints.size(); ++i)
             {
                 glm::vec3 pointColor = (i == selectedPointIndex) ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
-                Mesh sphereMesh = createSphere(SPHERE_RADIUS, 16, 32, pointColor);
+                Mesh sphereMesh = createSphere(SPHERE_RADIUS, 16, 32, pointColor, true);
                 glm::vec3 pointWorld = slidePos + glm::vec3(slideCurve.controlPoints[i].x, slideCurve.controlPoints[i].y, 0.0f);
                 glm::mat4 sphereTransform = glm::translate(glm::mat4(1.0f), pointWorld);
                 shader.setMat4("model", sphereTransform);
@@ -304,19 +797,116 @@ int main()
             }
         }
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        // Culling stats readout in the title bar
+        if (window && currentFrame - lastStatsTime > 0.5f)
+        {
+            lastStatsTime = currentFrame;
+            std::string title = "Animated Playground";
+            if (occlusionCullingEnabled)
+            {
+                const OcclusionStats &stats = occlusionCuller.getStats();
+                title += " | culled " + std::to_string(stats.rejected()) + "/" + std::to_string(stats.tested) +
+                         " draws (" + std::to_string(stats.occluded) + " occluded, " +
+                         std::to_string(stats.offscreen) + " off-screen)";
+            }
+            if (clusterCullingEnabled && meshletStats.tested > 0)
+            {
+                title += " | clusters " + std::to_string(meshletStats.tested - meshletStats.backfacing - meshletStats.offscreen) +
+                         "/" + std::to_string(meshletStats.tested) + " (" + std::to_string(meshletStats.backfacing) +
+                         " backfacing), triangles " + std::to_string(meshletStats.submittedTriangles) + "/" +
+                         std::to_string(meshletStats.totalTriangles);
+            }
+            glfwSetWindowTitle(window, title.c_str());
+        }
+
+        renderStats.endFrame();
+        if (statsOverlay)
+            renderStats.drawOverlay(textOverlay);
+
+        // after the ring's fence: deferred renderers such as llvmpipe only rasterize at that flush
+        streamBuffer.endFrame();
+        gpuProfiler.endFrame();
+        fixedClock.advance();
+        if (options.headless)
+        {
+            frameTimings.endFrame();
+            if (!options.pngDirectory.empty() && frame % options.pngEvery == 0)
+            {
+                PROFILE_SCOPE("savePNG");
+                char name[32];
+                std::snprintf(name, sizeof(name), "/frame_%05d.png", frame);
+                headlessContext.savePNG(options.pngDirectory + name);
+            }
+        }
+        else
+        {
+            PROFILE_SCOPE("swapBuffers");
+            glfwSwapBuffers(window);
+            // the callbacks fire in here and act on the next frame, so that's when a replay delivers them
+            inputTrace.setTime(clock.now());
+            glfwPollEvents();
+        }
+        profiler.endFrame();
+
+        if (window && profileStats && currentFrame - lastProfilePrintTime > PROFILE_PRINT_INTERVAL)
+        {
+            lastProfilePrintTime = currentFrame;
+            profiler.printStats();
+        }
     }
 
-    glfwTerminate();
+    if (options.headless)
+    {
+        glFinish();
+        frameTimings.finish();
+        frameTimings.printSummary(std::min(10, frame / 10));
+        if (!options.statsPath.empty())
+            frameTimings.writeCSV(options.statsPath);
+        if (options.profile)
+            profiler.printStats();
+    }
+    profiler.finish();
+
+    inputTrace.save();
+    renderStats.finish();
+    textOverlay.destroy();
+    gpuProfiler.destroy();
+    for (CurvePatch &patch : curvePatches)
+        patch.destroy();
+    streamBuffer.destroy();
+    if (options.headless)
+        headlessContext.destroy();
+    else
+        glfwTerminate();
     return 0;
 }
 
+void setFrameUniforms(Shader &shader, const glm::mat4 &projection, const glm::mat4 &view)
+{
+    shader.setMat4("projection", projection);
+    shader.setMat4("view", view);
+    shader.setBool("lightingEnabled", lightingEnabled);
+    shader.setFloat("ambientStrength", 0.3f);
+    shader.setFloat("lightStrength", 0.8f);
+    shader.setFloat("shininess", 25.0f);
+    shader.setVec3("lightPos", glm::vec3(50.0f, 100.0f, 50.0f));
+    shader.setVec3("viewPos", camera.position);
+}
+
+// Scene object drawn from the shared tessellation cache, full detail by default
+SceneObject makePrimitiveObject(const PrimitiveDesc &desc, const glm::mat4 &transform, bool occluder)
+{
+    SceneObject obj{tessellationCache.get(desc, 0), transform, occluder};
+    obj.procedural = true;
+    obj.primitive = desc;
+    return obj;
+}
+
 void createParkScene(std::vector<SceneObject> &objects)
 {
     // ground plane
     {
-        SceneObject ground{createPlane(60.0f, 60.0f, COLOR_GROUND), glm::mat4(1.0f)};
+        SceneObject ground{createPlane(60.0f, 60.0f, COLOR_GROUND), glm::mat4(1.0f), true};
         objects.push_back(ground);
     }
 
@@ -324,7 +914,7 @@ void createParkScene(std::vector<SceneObject> &objects)
     {
         glm::mat4 platMat = glm::translate(glm::mat4(1.0f), slidePos + glm::vec3(0.0f, platformHeight, 0.0f));
         platMat = glm::scale(platMat, glm::vec3(2.0f, 0.2f, slideWidth + 0.2f));
-        SceneObject plat{createCube(1.0f, COLOR_RED), platMat};
+        SceneObject plat{createCube(1.0f, COLOR_RED), platMat, true};
         objects.push_back(plat);
 
         glm::vec3 ladderTop(-1.0f, platformHeight, 0.0f);
@@ -340,7 +930,7 @@ void createParkScene(std::vector<SceneObject> &objects)
             mid.z = z;
             glm::mat4 railMat = glm::translate(glm::mat4(1.0f), slidePos + mid);
             railMat = glm::rotate(railMat, glm::radians(ladderAngle), glm::vec3(0, 0, 1));
-            SceneObject rail{createCylinder(0.1f, ladderLen, 12, COLOR_YELLOW), railMat};
+            SceneObject rail = makePrimitiveObject({SHAPE_CYLINDER, 0.1f, ladderLen, 12, COLOR_YELLOW}, railMat);
             objects.push_back(rail);
         }
 
@@ -351,7 +941,7 @@ void createParkScene(std::vector<SceneObject> &objects)
             glm::vec3 pos = ladderBase + ladderVec * t;
             glm::mat4 rungMat = glm::translate(glm::mat4(1.0f), slidePos + pos);
             rungMat = glm::rotate(rungMat, glm::radians(90.0f), glm::vec3(1, 0, 0));
-            SceneObject rung{createCylinder(0.08f, slideWidth * 0.8f, 8, COLOR_YELLOW), rungMat};
+            SceneObject rung = makePrimitiveObject({SHAPE_CYLINDER, 0.08f, slideWidth * 0.8f, 8, COLOR_YELLOW}, rungMat);
             objects.push_back(rung);
         }
 
@@ -361,7 +951,7 @@ void createParkScene(std::vector<SceneObject> &objects)
         slideCurve.controlPoints.push_back(glm::vec2(4.0f, 0.5f));
         slideCurve.controlPoints.push_back(glm::vec2(5.5f, 0.5f));
 
-        Mesh bezierMesh = slideCurve.createSlideExtrusion(slideWidth, 0.3f, 20, COLOR_RED);
+        Mesh bezierMesh = slideCurve.createSlideExtrusion(slideWidth, 0.3f, 20, COLOR_RED, true);
         glm::mat4 slideMat = glm::translate(glm::mat4(1.0f), slidePos);
         SceneObject slide{bezierMesh, slideMat};
         slideObjectIndex = objects.size();
@@ -372,7 +962,7 @@ void createParkScene(std::vector<SceneObject> &objects)
             float z = s * (slideWidth * 0.35f);
             glm::vec3 postPos(0.8f, platformHeight / 2.0f, z);
             glm::mat4 pMat = glm::translate(glm::mat4(1.0f), slidePos + postPos);
-            SceneObject post{createCylinder(0.1f, platformHeight, 12, COLOR_YELLOW), pMat};
+            SceneObject post = makePrimitiveObject({SHAPE_CYLINDER, 0.1f, platformHeight, 12, COLOR_YELLOW}, pMat);
             objects.push_back(post);
         }
     }
@@ -403,20 +993,20 @@ void createParkScene(std::vector<SceneObject> &objects)
             glm::vec3 midF = (footFront + topPoint) * 0.5f;
             glm::mat4 matF = glm::translate(glm::mat4(1.0f), swingPos + glm::vec3(x, midF.y, midF.z));
             matF = glm::rotate(matF, angleFront, glm::vec3(1, 0, 0));
-            SceneObject legF{createCylinder(0.15f, legLen, 12, COLOR_BLUE), matF};
+            SceneObject legF = makePrimitiveObject({SHAPE_CYLINDER, 0.15f, legLen, 12, COLOR_BLUE}, matF);
             objects.push_back(legF);
 
             glm::vec3 midB = (footBack + topPoint) * 0.5f;
             glm::mat4 matB = glm::translate(glm::mat4(1.0f), swingPos + glm::vec3(x, midB.y, midB.z));
             matB = glm::rotate(matB, angleBack, glm::vec3(1, 0, 0));
-            SceneObject legB{createCylinder(0.15f, legLen, 12, COLOR_BLUE), matB};
+            SceneObject legB = makePrimitiveObject({SHAPE_CYLINDER, 0.15f, legLen, 12, COLOR_BLUE}, matB);
             objects.push_back(legB);
         }
 
         // Top bar (static)
         glm::mat4 barMat = glm::translate(glm::mat4(1.0f), swingPos + topPoint);
         barMat = glm::rotate(barMat, glm::radians(90.0f), glm::vec3(0, 0, 1));
-        SceneObject topBar{createCylinder(0.15f, frameWidthX + 1.0f, 12, COLOR_BLUE), barMat};
+        SceneObject topBar = makePrimitiveObject({SHAPE_CYLINDER, 0.15f, frameWidthX + 1.0f, 12, COLOR_BLUE}, barMat);
         objects.push_back(topBar);
 
         // Seats and chains (animated)
@@ -445,7 +1035,7 @@ void createParkScene(std::vector<SceneObject> &objects)
                 float chainX = seatX + (c * 0.3f);
                 float chainMidY = seatY + (chainLen / 2.0f);
                 glm::mat4 chainMat = glm::translate(glm::mat4(1.0f), swingPos + glm::vec3(chainX, chainMidY, 0.0f));
-                SceneObject chain{createCylinder(0.02f, chainLen, 6, glm::vec3(0.2f)), chainMat};
+                SceneObject chain = makePrimitiveObject({SHAPE_CYLINDER, 0.02f, chainLen, 6, glm::vec3(0.2f)}, chainMat);
                 swing.chainIndices.push_back(objects.size());
                 objects.push_back(chain);
             }
@@ -467,7 +1057,7 @@ void createParkScene(std::vector<SceneObject> &objects)
 
         // Central hub (static)
         glm::mat4 hubMat = glm::translate(glm::mat4(1.0f), mgrPos + glm::vec3(0, 0.5f, 0));
-        SceneObject hub{createCylinder(0.5f, 1.2f, 16, COLOR_YELLOW), hubMat};
+        SceneObject hub = makePrimitiveObject({SHAPE_CYLINDER, 0.5f, 1.2f, 16, COLOR_YELLOW}, hubMat);
         objects.push_back(hub);
 
         // Disc segments (animated)
@@ -476,7 +1066,7 @@ void createParkScene(std::vector<SceneObject> &objects)
             glm::vec3 color = (i % 2 == 0) ? COLOR_PINK : COLOR_DEEP_BLUE;
             glm::mat4 segMat = glm::translate(glm::mat4(1.0f), mgrPos);
             segMat = glm::rotate(segMat, glm::radians(i * sectorAngle), glm::vec3(0, 1, 0));
-            SceneObject seg{createCylinderSector(radius, thickness, sectorAngle, 8, color), segMat};
+            SceneObject seg = makePrimitiveObject({SHAPE_CYLINDER_SECTOR, radius, thickness, 8, color, sectorAngle}, segMat);
             merryGoRound.segmentIndices.push_back(objects.size());
             objects.push_back(seg);
         }
@@ -485,7 +1075,7 @@ void createParkScene(std::vector<SceneObject> &objects)
         float ringRadius = radius * 0.8f;
         float ringHeight = 1.0f;
         glm::mat4 railMat = glm::translate(glm::mat4(1.0f), mgrPos + glm::vec3(0.0f, ringHeight, 0.0f));
-        SceneObject rail{createTorus(ringRadius, 0.05f, 32, 12, glm::vec3(0.7f)), railMat};
+        SceneObject rail = makePrimitiveObject({SHAPE_TORUS, ringRadius, 0.05f, 32, glm::vec3(0.7f), 360.0f, 12}, railMat);
         merryGoRound.railIndex = objects.size();
         objects.push_back(rail);
 
@@ -496,7 +1086,7 @@ void createParkScene(std::vector<SceneObject> &objects)
             float x = sin(angle) * ringRadius;
             float z = cos(angle) * ringRadius;
             glm::mat4 rodMat = glm::translate(glm::mat4(1.0f), mgrPos + glm::vec3(x, ringHeight / 2.0f, z));
-            SceneObject rod{createCylinder(0.04f, ringHeight, 8, glm::vec3(0.7f)), rodMat};
+            SceneObject rod = makePrimitiveObject({SHAPE_CYLINDER, 0.04f, ringHeight, 8, glm::vec3(0.7f)}, rodMat);
             merryGoRound.rodIndices.push_back(objects.size());
             objects.push_back(rod);
         }
@@ -570,137 +1160,341 @@ void createParkScene(std::vector<SceneObject> &objects)
 
         // Tree trunk (cylinder)
         glm::mat4 trunkMat = glm::translate(glm::mat4(1.0f), treePos + glm::vec3(0.0f, trunkHeight / 2.0f, 0.0f));
-        SceneObject trunk{createCylinder(trunkRadius, trunkHeight, 16, COLOR_TRUNK), trunkMat};
+        SceneObject trunk = makePrimitiveObject({SHAPE_CYLINDER, trunkRadius, trunkHeight, 16, COLOR_TRUNK}, trunkMat);
         objects.push_back(trunk);
 
         // Tree foliage - layered cones for fuller appearance
         // Bottom cone layer
         glm::mat4 coneMat1 = glm::translate(glm::mat4(1.0f), treePos + glm::vec3(0.0f, trunkHeight, 0.0f));
-        SceneObject cone1{createCone(coneRadius, coneHeight, 16, COLOR_FOLIAGE), coneMat1};
+        SceneObject cone1 = makePrimitiveObject({SHAPE_CONE, coneRadius, coneHeight, 16, COLOR_FOLIAGE}, coneMat1, true);
         objects.push_back(cone1);
 
         // Middle cone layer (slightly smaller and offset upward)
         glm::mat4 coneMat2 = glm::translate(glm::mat4(1.0f), treePos + glm::vec3(0.0f, trunkHeight + coneHeight * 0.5f, 0.0f));
-        SceneObject cone2{createCone(coneRadius * 0.75f, coneHeight * 0.8f, 16, COLOR_FOLIAGE), coneMat2};
+        SceneObject cone2 = makePrimitiveObject({SHAPE_CONE, coneRadius * 0.75f, coneHeight * 0.8f, 16, COLOR_FOLIAGE}, coneMat2, true);
         objects.push_back(cone2);
 
         // Top cone layer (smallest)
         glm::mat4 coneMat3 = glm::translate(glm::mat4(1.0f), treePos + glm::vec3(0.0f, trunkHeight + coneHeight * 0.9f, 0.0f));
-        SceneObject cone3{createCone(coneRadius * 0.5f, coneHeight * 0.6f, 16, COLOR_FOLIAGE), coneMat3};
+        SceneObject cone3 = makePrimitiveObject({SHAPE_CONE, coneRadius * 0.5f, coneHeight * 0.6f, 16, COLOR_FOLIAGE}, coneMat3, true);
         objects.push_back(cone3);
     }
 }
 
 void processInput(GLFWwindow *window)
 {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
+    if (inputTrace.key(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        if (window)
+            glfwSetWindowShouldClose(window, true);
 
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+    if (inputTrace.key(window, GLFW_KEY_W) == GLFW_PRESS)
         camera.processKeyboard(FORWARD, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+    if (inputTrace.key(window, GLFW_KEY_S) == GLFW_PRESS)
         camera.processKeyboard(BACKWARD, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+    if (inputTrace.key(window, GLFW_KEY_A) == GLFW_PRESS)
         camera.processKeyboard(LEFT, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+    if (inputTrace.key(window, GLFW_KEY_D) == GLFW_PRESS)
         camera.processKeyboard(RIGHT, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
+    if (inputTrace.key(window, GLFW_KEY_SPACE) == GLFW_PRESS)
         camera.processKeyboard(UP, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS)
+    if (inputTrace.key(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS)
         camera.processKeyboard(DOWN, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+    if (inputTrace.key(window, GLFW_KEY_Q) == GLFW_PRESS)
         camera.processRoll(1.0f * deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+    if (inputTrace.key(window, GLFW_KEY_E) == GLFW_PRESS)
         camera.processRoll(-1.0f * deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS)
+    if (inputTrace.key(window, GLFW_KEY_R) == GLFW_PRESS)
         camera.resetRoll();
 
     static bool bKeyPressed = false;
-    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS && !bKeyPressed)
+    if (inputTrace.key(window, GLFW_KEY_B) == GLFW_PRESS && !bKeyPressed)
     {
-        drawEdges = !drawEdges;
+        edgeMode = static_cast<EdgeMode>((edgeMode + 1) % 3);
         bKeyPressed = true;
+        const char *names[] = {"OFF", "LINES", "WIREFRAME"};
+        std::cout << "Edges: " << names[edgeMode] << std::endl;
     }
-    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_RELEASE)
+    if (inputTrace.key(window, GLFW_KEY_B) == GLFW_RELEASE)
     {
         bKeyPressed = false;
     }
+    static bool fKeyPressed = false;
+    if (inputTrace.key(window, GLFW_KEY_F) == GLFW_PRESS && !fKeyPressed)
+    {
+        fKeyPressed = true;
+        Mesh::featureEdgeAngle = (Mesh::featureEdgeAngle > 0.0f) ? 0.0f : 30.0f;
+        if (g_sceneObjects)
+        {
+            for (auto &obj : *g_sceneObjects)
+            {
+                obj.mesh.rebuildEdges(Mesh::featureEdgeAngle);
+                for (Mesh &level : obj.lods.levels)
+                    level.rebuildEdges(Mesh::featureEdgeAngle);
+            }
+            tessellationCache.rebuildEdges(Mesh::featureEdgeAngle);
+        }
+        std::cout << "Edge lines: " << (Mesh::featureEdgeAngle > 0.0f ? "feature edges only" : "all edges") << std::endl;
+    }
+    if (inputTrace.key(window, GLFW_KEY_F) == GLFW_RELEASE)
+    {
+        fKeyPressed = false;
+    }
     static bool oKeyPressed = false;
-    if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS && !oKeyPressed)
+    if (inputTrace.key(window, GLFW_KEY_O) == GLFW_PRESS && !oKeyPressed)
     {
         oKeyPressed = true;
 
         std::cout << "[INFO] Attempting to load model..." << std::endl;
 
-        Model loadedModel("../surface.off", COLOR_RED);
+        // every connected part becomes its own object, so it is culled and LOD-ed on its own
+        ModelLoadOptions options;
+        options.subdivisionLevels = subdivisionLevels;
+        options.splitComponents = true;
+        options.smallPartTriangles = SMALL_PART_TRIANGLES;
+        options.buildMeshlets = true;
+        Model loadedModel("../surface.off", COLOR_RED, options);
+
+        // BezierGL saves the profile curve next to the surface; with it the
+        // surface can be drawn as a revolution patch instead of the mesh
+        int patch = -1;
+        BezierCurve profile;
+        if (!loadedModel.meshes.empty() && CurvePatch::supported() && profile.readControlPoints("../surface.curve"))
+        {
+            patch = (int)curvePatches.size();
+            curvePatches.push_back(CurvePatch::revolution(profile.controlPoints, loadedModel.meshes[0].vertices[0].color));
+            std::cout << "[INFO] (PATCH) revolution patch from " << profile.controlPoints.size() << " control points" << std::endl;
+        }
 
         if (!loadedModel.meshes.empty())
         {
-            SceneObject newObj;
-
-            newObj.mesh = loadedModel.meshes[0];
+            glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 2.0f, 0.0f));
+            transform = glm::rotate(transform, glm::radians(-90.0f), glm::vec3(1, 0, 0));
 
-            newObj.transform = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 2.0f, 0.0f));
-
-            newObj.transform = glm::rotate(newObj.transform, glm::radians(-90.0f), glm::vec3(1, 0, 0));
-
-            if (g_sceneObjects)
-                g_sceneObjects->push_back(newObj);
-            std::cout << "[SUCCESS] Added model to scene." << std::endl;
+            for (size_t i = 0; i < loadedModel.meshes.size(); ++i)
+            {
+                SceneObject newObj;
+                newObj.mesh = loadedModel.meshes[i];
+                newObj.meshlets = loadedModel.meshlets[i];
+                newObj.lods = buildLodChain(newObj.mesh);
+                newObj.transform = transform;
+                newObj.patch = patch;
+
+                if (g_sceneObjects)
+                    g_sceneObjects->push_back(newObj);
+            }
+            std::cout << "[SUCCESS] Added model to scene (" << loadedModel.meshes.size() << " parts)." << std::endl;
         }
         else
         {
             std::cout << "[ERROR] Model failed to load or contained no meshes." << std::endl;
         }
     }
-    if (glfwGetKey(window, GLFW_KEY_O) == GLFW_RELEASE)
+    if (inputTrace.key(window, GLFW_KEY_O) == GLFW_RELEASE)
     {
         oKeyPressed = false;
     }
+    static bool tKeyPressed = false;
+    if (inputTrace.key(window, GLFW_KEY_T) == GLFW_PRESS && !tKeyPressed)
+    {
+        tKeyPressed = true;
+        if (CurvePatch::supported())
+        {
+            tessellationEnabled = !tessellationEnabled;
+            std::cout << "Tessellated curve patches: " << (tessellationEnabled ? "ON" : "OFF") << std::endl;
+        }
+        else
+        {
+            std::cout << "[WARN] Tessellated curve patches need an OpenGL 4.0 context" << std::endl;
+        }
+    }
+    if (inputTrace.key(window, GLFW_KEY_T) == GLFW_RELEASE)
+    {
+        tKeyPressed = false;
+    }
+    static bool uKeyPressed = false;
+    if (inputTrace.key(window, GLFW_KEY_U) == GLFW_PRESS && !uKeyPressed)
+    {
+        subdivisionLevels = (subdivisionLevels + 1) % (MAX_SUBDIVISION_LEVELS + 1);
+        uKeyPressed = true;
+        std::cout << "Subdivision levels for loaded models: " << subdivisionLevels << std::endl;
+    }
+    if (inputTrace.key(window, GLFW_KEY_U) == GLFW_RELEASE)
+    {
+        uKeyPressed = false;
+    }
+    static bool kKeyPressed = false;
+    if (inputTrace.key(window, GLFW_KEY_K) == GLFW_PRESS && !kKeyPressed)
+    {
+        clusterCullingEnabled = !clusterCullingEnabled;
+        kKeyPressed = true;
+        std::cout << "Cluster culling: " << (clusterCullingEnabled ? "ON" : "OFF") << std::endl;
+    }
+    if (inputTrace.key(window, GLFW_KEY_K) == GLFW_RELEASE)
+    {
+        kKeyPressed = false;
+    }
+    static bool cKeyPressed = false;
+    if (inputTrace.key(window, GLFW_KEY_C) == GLFW_PRESS && !cKeyPressed)
+    {
+        occlusionCullingEnabled = !occlusionCullingEnabled;
+        cKeyPressed = true;
+        std::cout << "Occlusion culling: " << (occlusionCullingEnabled ? "ON" : "OFF") << std::endl;
+    }
+    if (inputTrace.key(window, GLFW_KEY_C) == GLFW_RELEASE)
+    {
+        cKeyPressed = false;
+    }
+    static bool mKeyPressed = false;
+    if (inputTrace.key(window, GLFW_KEY_M) == GLFW_PRESS && !mKeyPressed)
+    {
+        lodEnabled = !lodEnabled;
+        mKeyPressed = true;
+        std::cout << "LOD: " << (lodEnabled ? "ON" : "OFF") << std::endl;
+    }
+    if (inputTrace.key(window, GLFW_KEY_M) == GLFW_RELEASE)
+    {
+        mKeyPressed = false;
+    }
     static bool lKeyPressed = false;
-    if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS && !lKeyPressed)
+    if (inputTrace.key(window, GLFW_KEY_L) == GLFW_PRESS && !lKeyPressed)
     {
         lightingEnabled = !lightingEnabled;
         lKeyPressed = true;
     }
-    if (glfwGetKey(window, GLFW_KEY_L) == GLFW_RELEASE)
+    if (inputTrace.key(window, GLFW_KEY_L) == GLFW_RELEASE)
     {
         lKeyPressed = false;
     }
 
+    // Camera path: N records keyframes (saved right away), V plays them back
+    static bool nKeyPressed = false;
+    if (inputTrace.key(window, GLFW_KEY_N) == GLFW_PRESS && !nKeyPressed)
+    {
+        nKeyPressed = true;
+        static bool recordingPath = false;
+        if (!recordingPath)
+        {
+            cameraPath.clear(); // the first N starts a new path instead of extending the tour
+            recordingPath = true;
+        }
+        cameraPath.addKeyframe(camera);
+        cameraPath.save(CAMERA_PATH_FILE);
+        std::cout << "Camera keyframe " << cameraPath.keyframes.size() << " added" << std::endl;
+    }
+    if (inputTrace.key(window, GLFW_KEY_N) == GLFW_RELEASE)
+    {
+        nKeyPressed = false;
+    }
+
+    static bool xKeyPressed = false;
+    if (inputTrace.key(window, GLFW_KEY_X) == GLFW_PRESS && !xKeyPressed)
+    {
+        xKeyPressed = true;
+        cameraPath.clear();
+        cameraPathPlaying = false;
+        cameraPath.save(CAMERA_PATH_FILE);
+        std::cout << "Camera path cleared" << std::endl;
+    }
+    if (inputTrace.key(window, GLFW_KEY_X) == GLFW_RELEASE)
+    {
+        xKeyPressed = false;
+    }
+
+    static bool vKeyPressed = false;
+    if (inputTrace.key(window, GLFW_KEY_V) == GLFW_PRESS && !vKeyPressed)
+    {
+        vKeyPressed = true;
+        if (cameraPath.playable())
+        {
+            cameraPathPlaying = !cameraPathPlaying;
+            cameraPathDistance = 0.0f;
+            std::cout << "Camera path: " << (cameraPathPlaying ? "PLAYING" : "STOPPED") << std::endl;
+        }
+        else
+        {
+            std::cout << "[WARN] The camera path needs two or more keyframes (N adds one)" << std::endl;
+        }
+    }
+    if (inputTrace.key(window, GLFW_KEY_V) == GLFW_RELEASE)
+    {
+        vKeyPressed = false;
+    }
+
+    // CPU profiler: I toggles it with a stats printout, J traces the next frames
+    static bool iKeyPressed = false;
+    if (inputTrace.key(window, GLFW_KEY_I) == GLFW_PRESS && !iKeyPressed)
+    {
+        iKeyPressed = true;
+        profileStats = !profileStats;
+        Profiler::instance().setEnabled(profileStats || Profiler::instance().capturing());
+        std::cout << "CPU profiler: " << (profileStats ? "ON" : "OFF") << std::endl;
+    }
+    if (inputTrace.key(window, GLFW_KEY_I) == GLFW_RELEASE)
+    {
+        iKeyPressed = false;
+    }
+
+    static bool jKeyPressed = false;
+    if (inputTrace.key(window, GLFW_KEY_J) == GLFW_PRESS && !jKeyPressed)
+    {
+        jKeyPressed = true;
+        if (!Profiler::instance().capturing())
+            Profiler::instance().captureTrace(TRACE_FILE, Profiler::instance().frameIndex() + 1, TRACE_FRAMES);
+    }
+    if (inputTrace.key(window, GLFW_KEY_J) == GLFW_RELEASE)
+    {
+        jKeyPressed = false;
+    }
+
+    // Renderer stats overlay
+    static bool hKeyPressed = false;
+    if (inputTrace.key(window, GLFW_KEY_H) == GLFW_PRESS && !hKeyPressed)
+    {
+        hKeyPressed = true;
+        statsOverlay = !statsOverlay;
+        std::cout << "Renderer stats overlay: " << (statsOverlay ? "ON" : "OFF") << std::endl;
+    }
+    if (inputTrace.key(window, GLFW_KEY_H) == GLFW_RELEASE)
+    {
+        hKeyPressed = false;
+    }
+
     // Animation toggle
     static bool aKeyPressed = false;
-    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS && !aKeyPressed)
+    if (inputTrace.key(window, GLFW_KEY_P) == GLFW_PRESS && !aKeyPressed)
     {
         animationsEnabled = !animationsEnabled;
         aKeyPressed = true;
         std::cout << "Animations: " << (animationsEnabled ? "ON" : "OFF") << std::endl;
     }
-    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_RELEASE)
+    if (inputTrace.key(window, GLFW_KEY_P) == GLFW_RELEASE)
     {
         aKeyPressed = false;
     }
 
     // Edit mode toggle
     static bool tabKeyPressed = false;
-    if (glfwGetKey(window, GLFW_KEY_TAB) == GLFW_PRESS && !tabKeyPressed)
+    if (inputTrace.key(window, GLFW_KEY_TAB) == GLFW_PRESS && !tabKeyPressed)
     {
         editMode = !editMode;
         tabKeyPressed = true;
         if (editMode)
         {
-            glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+            if (window)
+                glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
             std::cout << "Edit Mode: ON - Left click to select/add, Right click to delete" << std::endl;
         }
         else
         {
-            glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+            if (window)
+                glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
             isDragging = false;
             selectedPointIndex = -1;
+            freezeSlide();
             std::cout << "Edit Mode: OFF" << std::endl;
         }
     }
-    if (glfwGetKey(window, GLFW_KEY_TAB) == GLFW_RELEASE)
+    if (inputTrace.key(window, GLFW_KEY_TAB) == GLFW_RELEASE)
     {
         tabKeyPressed = false;
     }
@@ -713,6 +1507,9 @@ void framebuffer_size_callback(GLFWwindow *window, int width, int height)
 
 void mouse_callback(GLFWwindow *window, double xposIn, double yposIn)
 {
+    if (!inputTrace.cursor(xposIn, yposIn))
+        return;
+
     float xpos = static_cast<float>(xposIn);
     float ypos = static_cast<float>(yposIn);
 
@@ -721,7 +1518,7 @@ void mouse_callback(GLFWwindow *window, double xposIn, double yposIn)
         if (isDragging && selectedPointIndex != -1)
         {
             int width, height;
-            glfwGetFramebufferSize(window, &width, &height);
+            framebufferSize(width, height);
             glm::mat4 projection = glm::perspective(glm::radians(camera.zoom),
                                                     (float)width / (float)height, 0.1f, 100.0f);
             glm::mat4 view = camera.getViewMatrix();
@@ -751,14 +1548,14 @@ void mouse_callback(GLFWwindow *window, double xposIn, double yposIn)
 
 void mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
 {
-    if (!editMode)
+    if (!inputTrace.button(button, action, mods) || !editMode)
         return;
 
     double xpos, ypos;
-    glfwGetCursorPos(window, &xpos, &ypos);
+    inputTrace.cursorPos(window, &xpos, &ypos);
 
     int width, height;
-    glfwGetFramebufferSize(window, &width, &height);
+    framebufferSize(width, height);
     glm::mat4 projection = glm::perspective(glm::radians(camera.zoom),
                                             (float)width / (float)height, 0.1f, 100.0f);
     glm::mat4 view = camera.getViewMatrix();
@@ -806,5 +1603,7 @@ void mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
 
 void scroll_callback(GLFWwindow *window, double xoffset, double yoffset)
 {
+    if (!inputTrace.scroll(xoffset, yoffset))
+        return;
     camera.processScroll(static_cast<float>(yoffset));
 }
@@ -5,9 +5,15 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "shader.h"
+#include "stream_buffer.h"
+#include "profiler.h"
+#include "render_stats.h"
 
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cmath>
 #include <fstream>  // Required for file output
 #include <iostream> // Required for error printing
 
@@ -18,37 +24,264 @@ struct Vertex
     glm::vec3 color;
 };
 
+// Compact GPU-side vertex layout (16 bytes instead of 36):
+// positions are unorm16 relative to the mesh bounds, normals are packed
+// 10:10:10:2 snorm and colors are rgba8. Dequantized in shader.vert.
+struct PackedVertex
+{
+    uint16_t position[4]; // xyz, w is padding
+    uint32_t normal;
+    uint8_t color[4];
+};
+
+uint32_t packNormal1010102(const glm::vec3 &n)
+{
+    auto snorm10 = [](float v)
+    {
+        int q = static_cast<int>(std::round(glm::clamp(v, -1.0f, 1.0f) * 511.0f));
+        return static_cast<uint32_t>(q) & 0x3FFu;
+    };
+    return snorm10(n.x) | (snorm10(n.y) << 10) | (snorm10(n.z) << 20);
+}
+
+uint8_t packUnorm8(float v)
+{
+    return static_cast<uint8_t>(std::round(glm::clamp(v, 0.0f, 1.0f) * 255.0f));
+}
+
+// Separates strips in a strip index list (converted to 0xFFFF for 16-bit uploads)
+const unsigned int RESTART_INDEX = 0xFFFFFFFF;
+
+// Appends one triangle strip zig-zagging between two grid rows (a0 b0 a1 b1 ...)
+// followed by a restart. With wrap set, column count wraps back to column 0.
+void appendStripRow(std::vector<unsigned int> &strip, unsigned int rowA, unsigned int rowB, int columns, int wrap = 0)
+{
+    for (int j = 0; j < columns; ++j)
+    {
+        unsigned int col = wrap ? static_cast<unsigned int>(j % wrap) : static_cast<unsigned int>(j);
+        strip.push_back(rowA + col);
+        strip.push_back(rowB + col);
+    }
+    strip.push_back(RESTART_INDEX);
+}
+
+// Counts gathered while extracting edges, useful for quick mesh analysis
+struct EdgeStats
+{
+    size_t unique = 0;      // distinct undirected edges
+    size_t boundary = 0;    // edges used by a single triangle
+    size_t nonManifold = 0; // edges shared by more than two triangles
+    size_t emitted = 0;     // edges written to the line list
+};
+
+// Builds a GL_LINES index list with every undirected edge exactly once, in the
+// order edges are first seen. With featureAngle > 0 (degrees) only edges whose
+// two faces bend by more than that angle are kept, plus boundary and
+// non-manifold edges.
+std::vector<unsigned int> extractUniqueEdges(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices,
+                                             float featureAngle = 0.0f, EdgeStats *stats = nullptr)
+{
+    struct EdgeRecord
+    {
+        unsigned int a, b;
+        unsigned int firstFace;
+        unsigned int faceCount;
+        bool feature;
+    };
+
+    bool filter = featureAngle > 0.0f;
+    float cosThreshold = std::cos(glm::radians(featureAngle));
+
+    std::vector<glm::vec3> faceNormals;
+    if (filter)
+    {
+        faceNormals.resize(indices.size() / 3);
+        for (size_t f = 0; f < faceNormals.size(); ++f)
+        {
+            const glm::vec3 &p0 = vertices[indices[f * 3]].position;
+            const glm::vec3 &p1 = vertices[indices[f * 3 + 1]].position;
+            const glm::vec3 &p2 = vertices[indices[f * 3 + 2]].position;
+            glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            float len = glm::length(n);
+            faceNormals[f] = (len > 0.0f) ? n / len : glm::vec3(0.0f);
+        }
+    }
+
+    // undirected edge key (smaller index in the high half) -> slot in records
+    std::unordered_map<uint64_t, unsigned int> lookup;
+    lookup.reserve(indices.size());
+    std::vector<EdgeRecord> records;
+    records.reserve(indices.size() / 2);
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        unsigned int face = static_cast<unsigned int>(i / 3);
+        for (int e = 0; e < 3; ++e)
+        {
+            unsigned int a = indices[i + e];
+            unsigned int b = indices[i + (e + 1) % 3];
+            if (a == b)
+                continue;
+
+            uint64_t key = (a < b) ? ((uint64_t)a << 32 | b) : ((uint64_t)b << 32 | a);
+            auto it = lookup.find(key);
+            if (it == lookup.end())
+            {
+                lookup.emplace(key, static_cast<unsigned int>(records.size()));
+                records.push_back({a, b, face, 1, false});
+                continue;
+            }
+
+            EdgeRecord &record = records[it->second];
+            record.faceCount++;
+            if (filter && !record.feature)
+            {
+                float d = glm::dot(faceNormals[record.firstFace], faceNormals[face]);
+                record.feature = d < cosThreshold;
+            }
+        }
+    }
+
+    std::vector<unsigned int> edges;
+    edges.reserve(records.size() * 2);
+    EdgeStats counts;
+    counts.unique = records.size();
+
+    for (const EdgeRecord &record : records)
+    {
+        if (record.faceCount == 1)
+            counts.boundary++;
+        else if (record.faceCount > 2)
+            counts.nonManifold++;
+
+        if (filter && record.faceCount == 2 && !record.feature)
+            continue;
+
+        edges.push_back(record.a);
+        edges.push_back(record.b);
+    }
+    counts.emitted = edges.size() / 2;
+
+    if (stats)
+        *stats = counts;
+    return edges;
+}
+
 class Mesh
 {
 public:
     std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
+    std::vector<unsigned int> indices;      // triangle list, always kept for CPU-side use
+    std::vector<unsigned int> stripIndices; // optional strips with RESTART_INDEX separators
     unsigned int edgeEBO;
     unsigned int edgeCount;
     unsigned int VAO;
 
+    // crease angle (degrees) used when building edge lists, 0 keeps every edge
+    inline static float featureEdgeAngle = 0.0f;
+
+    // upload new meshes in the PackedVertex layout
+    inline static bool compressVertices = false;
+
+    // packed-position dequantization, identity for float meshes
+    bool compressed = false;
+    glm::vec3 positionScale = glm::vec3(1.0f);
+    glm::vec3 positionOffset = glm::vec3(0.0f);
+
+    // local-space axis aligned bounds, used for culling
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+
     // Default constructor
-    Mesh() : edgeCount(0), VAO(0), VBO(0), EBO(0), edgeEBO(0) {}
+    Mesh() : edgeCount(0), VAO(0), VBO(0), EBO(0), edgeEBO(0), boundsMin(0.0f), boundsMax(0.0f) {}
+
+    // index buffer layout picked at upload time
+    GLenum indexType = GL_UNSIGNED_INT;
+    GLenum primitiveMode = GL_TRIANGLES;
+    unsigned int indexCount = 0;
 
-    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices)
+    // where the draws source from in the bound buffers, only non-zero for streamed meshes
+    size_t indexOffset = 0;
+    size_t edgeOffset = 0;
+    GLint baseVertex = 0;
+
+    // when stripIndices is given the GPU draws those instead of the triangle list
+    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<unsigned int> stripIndices = {})
     {
         this->vertices = vertices;
         this->indices = indices;
+        this->stripIndices = stripIndices;
 
+        computeBounds();
         setupMesh();
     }
 
     void draw(Shader &shader)
     {
+        setVertexUniforms(shader);
         glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
+        drawElements();
         glBindVertexArray(0);
     }
 
     void drawEdges(Shader &shader)
     {
+        setVertexUniforms(shader);
         glBindVertexArray(VAO);
+        drawEdgeElements();
+        glBindVertexArray(0);
+    }
 
+    // per-mesh uniforms the vertex shader needs to decode this mesh's layout
+    void setVertexUniforms(const Shader &shader) const
+    {
+        shader.setVec3("positionScale", positionScale);
+        shader.setVec3("positionOffset", positionOffset);
+    }
+
+    // Turns primitive restart on for the rest of the context's life, call once
+    // after loading GL. The restart value is the all-ones index of each index
+    // type, which triangle and edge lists never reach, so it can stay enabled.
+    static void enablePrimitiveRestart()
+    {
+        fixedRestartIndex = GLAD_GL_VERSION_4_3 != 0;
+        if (fixedRestartIndex)
+        {
+            glEnable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+            return;
+        }
+        glEnable(GL_PRIMITIVE_RESTART);
+        restartIndex = RESTART_INDEX;
+        glPrimitiveRestartIndex(restartIndex);
+    }
+
+    // Issue the triangle draw, assuming VAO is already bound (render queue path)
+    void drawElements() const
+    {
+        if (primitiveMode == GL_TRIANGLE_STRIP)
+        {
+            GLuint restart = indexType == GL_UNSIGNED_SHORT ? 0xFFFFu : RESTART_INDEX;
+            if (!fixedRestartIndex && restartIndex != restart)
+            {
+                restartIndex = restart;
+                glPrimitiveRestartIndex(restart);
+            }
+            glDrawElementsBaseVertex(GL_TRIANGLE_STRIP, indexCount, indexType, (void *)indexOffset, baseVertex);
+            RenderStats::instance().countTriangles(indices.size() / 3); // the strips skip restarts and degenerates
+            return;
+        }
+        glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, indexType, (void *)indexOffset, baseVertex);
+    }
+
+    // Issue several triangle-list sub-ranges (byte offsets into the EBO) in one call, VAO bound
+    void drawRanges(const std::vector<GLsizei> &counts, const std::vector<const void *> &offsets) const
+    {
+        glMultiDrawElements(GL_TRIANGLES, counts.data(), indexType, offsets.data(), (GLsizei)counts.size());
+    }
+
+    // Issue the edge draw, assuming VAO is already bound (render queue path)
+    void drawEdgeElements() const
+    {
         // temporarily disable the vertex color attribute and set a constant color (Black)
         glDisableVertexAttribArray(2);
         glVertexAttrib3f(2, 0.0f, 0.0f, 0.0f);
@@ -56,13 +289,11 @@ public:
         // bind edge EBO and draw
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, edgeEBO);
         glLineWidth(1.5f);
-        glDrawElements(GL_LINES, edgeCount, GL_UNSIGNED_INT, 0);
+        glDrawElementsBaseVertex(GL_LINES, edgeCount, indexType, (void *)edgeOffset, baseVertex);
 
         // restore triangle EBO and color attribute
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
         glEnableVertexAttribArray(2);
-
-        glBindVertexArray(0);
     }
 
     bool writeOFF(const std::string &filename) const
@@ -100,11 +331,160 @@ public:
         return true;
     }
 
+    // Rebuilds the edge EBO; featureAngle > 0 keeps only creases sharper than it (degrees)
+    void rebuildEdges(float featureAngle)
+    {
+        // streamed meshes extract their edges on every stream() call
+        if (streamSource != 0)
+            return;
+        std::vector<unsigned int> edges = extractUniqueEdges(vertices, indices, featureAngle);
+        edgeCount = static_cast<unsigned int>(edges.size());
+
+        // upload through GL_ARRAY_BUFFER so whatever VAO is bound keeps its EBO
+        glBindBuffer(GL_ARRAY_BUFFER, edgeEBO);
+        uploadIndices(GL_ARRAY_BUFFER, edges);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // Rewrites the mesh through a ring buffer instead of fresh GL buffers, for
+    // geometry rebuilt every frame. Vertices, triangle/strip indices and edges
+    // are copied into this frame's region; the VAO points at the ring once and
+    // the draws pick the data up through base vertex and index offsets.
+    // Returns false (and draws nothing) when the region had no room.
+    bool stream(StreamBuffer &ring, const std::vector<Vertex> &newVertices, const std::vector<unsigned int> &newIndices,
+                const std::vector<unsigned int> &newStripIndices = {})
+    {
+        vertices = newVertices;
+        indices = newIndices;
+        stripIndices = newStripIndices;
+        computeBounds();
+        if (streamSource == 0)
+            compressed = compressVertices;
+
+        indexCount = 0;
+        edgeCount = 0;
+        indexType = (vertices.size() < 0xFFFF) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        std::vector<PackedVertex> packed;
+        if (compressed)
+            packed = packVertices();
+        const std::vector<unsigned int> &gpuIndices = stripIndices.empty() ? indices : stripIndices;
+        std::vector<unsigned int> edges = extractUniqueEdges(vertices, indices, featureEdgeAngle);
+
+        // a write that grows the ring drops what this call wrote before it, so start over
+        unsigned int generation;
+        do
+        {
+            generation = ring.generation();
+            // vertex data aligned to its stride so the offset is a whole base vertex
+            size_t offset = 0;
+            bool ok;
+            if (compressed)
+            {
+                ok = ring.write(packed.data(), packed.size() * sizeof(PackedVertex), sizeof(PackedVertex), offset);
+                baseVertex = (GLint)(offset / sizeof(PackedVertex));
+            }
+            else
+            {
+                ok = ring.write(vertices.data(), vertices.size() * sizeof(Vertex), sizeof(Vertex), offset);
+                baseVertex = (GLint)(offset / sizeof(Vertex));
+            }
+            ok = ok && writeIndices(ring, gpuIndices, indexOffset) && writeIndices(ring, edges, edgeOffset);
+            if (!ok)
+                return false;
+        } while (generation != ring.generation());
+
+        if (streamSource != ring.buffer() || streamGeneration != generation)
+            setupStreamed(ring);
+
+        primitiveMode = stripIndices.empty() ? GL_TRIANGLES : GL_TRIANGLE_STRIP;
+        indexCount = static_cast<unsigned int>(gpuIndices.size());
+        edgeCount = static_cast<unsigned int>(edges.size());
+        return true;
+    }
+
+    bool isStreamed() const { return streamSource != 0; }
+
+    // Deletes the mesh's GL objects. A streamed mesh only owns its VAO: its
+    // VBO / EBO / edgeEBO name the ring, which belongs to the StreamBuffer.
+    void release()
+    {
+        if (VAO != 0)
+            glDeleteVertexArrays(1, &VAO);
+        if (streamSource == 0)
+        {
+            GLuint buffers[] = {VBO, EBO, edgeEBO};
+            glDeleteBuffers(3, buffers);
+        }
+        VAO = VBO = EBO = edgeEBO = 0;
+        streamSource = 0;
+        indexCount = edgeCount = 0;
+    }
+
+    void computeBounds()
+    {
+        boundsMin = glm::vec3(0.0f);
+        boundsMax = glm::vec3(0.0f);
+        if (vertices.empty())
+            return;
+
+        boundsMin = vertices[0].position;
+        boundsMax = vertices[0].position;
+        for (const auto &v : vertices)
+        {
+            boundsMin = glm::min(boundsMin, v.position);
+            boundsMax = glm::max(boundsMax, v.position);
+        }
+    }
+
 private:
+    // restart state set by enablePrimitiveRestart(), shared by every mesh
+    inline static bool fixedRestartIndex = false;
+    inline static GLuint restartIndex = RESTART_INDEX;
+
     unsigned int VBO, EBO;
+    GLuint streamSource = 0; // ring buffer the VAO reads from, 0 for static meshes
+    unsigned int streamGeneration = 0;
+
+    // one VAO reading vertices and all indices from the ring, re-pointed when it
+    // grows. A mesh built static drops its own buffers the first time; after that
+    // VBO / EBO / edgeEBO are the ring's and must never be deleted through the mesh.
+    void setupStreamed(StreamBuffer &ring)
+    {
+        if (streamSource == 0)
+        {
+            release();
+            glGenVertexArrays(1, &VAO);
+        }
+        streamSource = ring.buffer();
+        streamGeneration = ring.generation();
+        VBO = EBO = edgeEBO = streamSource;
+
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, streamSource);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, streamSource);
+        setupAttributes();
+        glBindVertexArray(0);
+    }
+
+    bool writeIndices(StreamBuffer &ring, const std::vector<unsigned int> &data, size_t &offset)
+    {
+        if (indexType == GL_UNSIGNED_INT)
+            return ring.write(data.data(), data.size() * sizeof(unsigned int), sizeof(unsigned int), offset);
+        std::vector<uint16_t> narrow = narrowIndices(data);
+        return ring.write(narrow.data(), narrow.size() * sizeof(uint16_t), sizeof(uint16_t), offset);
+    }
+
+    static std::vector<uint16_t> narrowIndices(const std::vector<unsigned int> &data)
+    {
+        std::vector<uint16_t> narrow(data.size());
+        for (size_t i = 0; i < data.size(); ++i)
+            narrow[i] = (data[i] == RESTART_INDEX) ? 0xFFFF : static_cast<uint16_t>(data[i]);
+        return narrow;
+    }
 
     void setupMesh()
     {
+        PROFILE_SCOPE("uploadMesh");
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
         glGenBuffers(1, &EBO);
@@ -112,46 +492,114 @@ private:
         glBindVertexArray(VAO);
 
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+        compressed = compressVertices;
+        if (compressed)
+            uploadPackedVertices();
+        else
+            glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
 
-        // build edge index list (each triangle gives three edges)
-        std::vector<unsigned int> edges;
-        for (size_t i = 0; i < indices.size(); i += 3)
-        {
-            if (i + 2 >= indices.size())
-                break; // Safety check
-            unsigned int a = indices[i];
-            unsigned int b = indices[i + 1];
-            unsigned int c = indices[i + 2];
-            edges.push_back(a);
-            edges.push_back(b);
-            edges.push_back(b);
-            edges.push_back(c);
-            edges.push_back(c);
-            edges.push_back(a);
-        }
+        // build edge index list, each shared edge only once
+        std::vector<unsigned int> edges = extractUniqueEdges(vertices, indices, featureEdgeAngle);
         edgeCount = static_cast<unsigned int>(edges.size());
 
+        // 16-bit indices whenever every vertex (and the 0xFFFF restart value) fits
+        indexType = (vertices.size() < 0xFFFF) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
         glGenBuffers(1, &edgeEBO);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, edgeEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, edges.size() * sizeof(unsigned int), edges.data(), GL_STATIC_DRAW);
+        uploadIndices(GL_ELEMENT_ARRAY_BUFFER, edges);
 
         // triangle EBO needs to be bound last
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-
-        // Position
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
-        // Normal
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, normal));
-        // Color
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, color));
+        const std::vector<unsigned int> &gpuIndices = stripIndices.empty() ? indices : stripIndices;
+        primitiveMode = stripIndices.empty() ? GL_TRIANGLES : GL_TRIANGLE_STRIP;
+        indexCount = static_cast<unsigned int>(gpuIndices.size());
+        uploadIndices(GL_ELEMENT_ARRAY_BUFFER, gpuIndices);
 
+        setupAttributes();
         glBindVertexArray(0);
     }
+
+    // vertex layout for the buffer bound to GL_ARRAY_BUFFER
+    void setupAttributes()
+    {
+        if (compressed)
+        {
+            // Position
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, position));
+            // Normal
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, normal));
+            // Color
+            glEnableVertexAttribArray(2);
+            glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, color));
+        }
+        else
+        {
+            // Position
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
+            // Normal
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, normal));
+            // Color
+            glEnableVertexAttribArray(2);
+            glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, color));
+        }
+    }
+
+    // upload to the buffer bound at target using this mesh's index type
+    void uploadIndices(GLenum target, const std::vector<unsigned int> &data)
+    {
+        if (indexType == GL_UNSIGNED_INT)
+        {
+            glBufferData(target, data.size() * sizeof(unsigned int), data.data(), GL_STATIC_DRAW);
+            return;
+        }
+
+        std::vector<uint16_t> narrow = narrowIndices(data);
+        glBufferData(target, narrow.size() * sizeof(uint16_t), narrow.data(), GL_STATIC_DRAW);
+    }
+
+    // quantize vertices against the mesh bounds and upload to the bound VBO
+    void uploadPackedVertices()
+    {
+        std::vector<PackedVertex> packed = packVertices();
+        glBufferData(GL_ARRAY_BUFFER, packed.size() * sizeof(PackedVertex), packed.data(), GL_STATIC_DRAW);
+    }
+
+    // quantize vertices against the mesh bounds, sets the dequantization uniforms
+    std::vector<PackedVertex> packVertices()
+    {
+        glm::vec3 extent = boundsMax - boundsMin;
+        positionOffset = boundsMin;
+        positionScale = extent;
+
+        glm::vec3 toUnorm;
+        for (int i = 0; i < 3; ++i)
+            toUnorm[i] = (extent[i] > 0.0f) ? 65535.0f / extent[i] : 0.0f;
+
+        std::vector<PackedVertex> packed(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            const Vertex &v = vertices[i];
+            PackedVertex &p = packed[i];
+
+            glm::vec3 q = (v.position - boundsMin) * toUnorm;
+            for (int c = 0; c < 3; ++c)
+                p.position[c] = static_cast<uint16_t>(glm::clamp(std::round(q[c]), 0.0f, 65535.0f));
+            p.position[3] = 0;
+
+            p.normal = packNormal1010102(v.normal);
+
+            p.color[0] = packUnorm8(v.color.r);
+            p.color[1] = packUnorm8(v.color.g);
+            p.color[2] = packUnorm8(v.color.b);
+            p.color[3] = 255;
+        }
+        return packed;
+    }
 };
 
 #endif
\ No newline at end of file
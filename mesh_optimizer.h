@@ -0,0 +1,507 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <glm/glm.hpp>
+#include "mesh.h"
+#include "profiler.h"
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <iostream>
+
+// Post-transform cache efficiency of an index list
+struct VertexCacheStats
+{
+    float acmr = 0.0f; // transformed vertices per triangle (0.5 is ideal on large grids)
+    float atvr = 0.0f; // transformed vertices per referenced vertex (1.0 is ideal)
+};
+
+// Simulates a FIFO post-transform cache of the given size over a triangle list
+VertexCacheStats analyzeVertexCache(const std::vector<unsigned int> &indices, size_t vertexCount, int cacheSize = 16)
+{
+    VertexCacheStats stats;
+    size_t triangles = indices.size() / 3;
+    if (triangles == 0)
+        return stats;
+
+    // timestamp of when each vertex entered the cache
+    std::vector<unsigned int> entered(vertexCount, 0);
+    std::vector<bool> referenced(vertexCount, false);
+    unsigned int time = cacheSize + 1;
+    size_t transformed = 0, unique = 0;
+
+    for (unsigned int index : indices)
+    {
+        if (!referenced[index])
+        {
+            referenced[index] = true;
+            unique++;
+        }
+        if (time - entered[index] > (unsigned int)cacheSize)
+        {
+            entered[index] = time++;
+            transformed++;
+        }
+    }
+
+    stats.acmr = (float)transformed / (float)triangles;
+    stats.atvr = (float)transformed / (float)unique;
+    return stats;
+}
+
+// Merges bitwise identical vertices and drops unreferenced ones.
+// Returns the new vertex count; indices are rewritten in place.
+size_t deduplicateVertices(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices)
+{
+    struct VertexHash
+    {
+        size_t operator()(const Vertex &v) const
+        {
+            const uint32_t *words = reinterpret_cast<const uint32_t *>(&v);
+            size_t h = 2166136261u;
+            for (size_t i = 0; i < sizeof(Vertex) / sizeof(uint32_t); ++i)
+                h = (h ^ words[i]) * 16777619u;
+            return h;
+        }
+    };
+    struct VertexEqual
+    {
+        bool operator()(const Vertex &a, const Vertex &b) const { return std::memcmp(&a, &b, sizeof(Vertex)) == 0; }
+    };
+
+    std::unordered_map<Vertex, unsigned int, VertexHash, VertexEqual> unique;
+    unique.reserve(indices.size());
+    std::vector<unsigned int> remap(vertices.size(), RESTART_INDEX);
+    std::vector<Vertex> result;
+
+    for (unsigned int &index : indices)
+    {
+        if (remap[index] == RESTART_INDEX)
+        {
+            auto it = unique.emplace(vertices[index], (unsigned int)result.size());
+            if (it.second)
+                result.push_back(vertices[index]);
+            remap[index] = it.first->second;
+        }
+        index = remap[index];
+    }
+
+    vertices.swap(result);
+    return vertices.size();
+}
+
+// Tolerances for weldVertices. Vertices merge only when all three match, so
+// creases (normals) and color boundaries stay as seams.
+struct WeldOptions
+{
+    float positionTolerance = 1e-5f; // world units
+    float normalAngle = 1.0f;        // degrees
+    float colorTolerance = 1.0f / 255.0f;
+};
+
+// Merges vertices within positionTolerance whose attributes also match, using a
+// spatial hash with cells of the tolerance size (a match can only be in the 27
+// surrounding cells). The first vertex of a cluster is kept as is. Indices and
+// optional strips are remapped, triangles that collapse or have zero area are
+// dropped and unreferenced vertices removed. Returns the new vertex count.
+size_t weldVertices(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices,
+                    const WeldOptions &options = WeldOptions(), std::vector<unsigned int> *strips = nullptr)
+{
+    PROFILE_SCOPE("weldVertices");
+    const unsigned int NONE = 0xFFFFFFFF;
+    float cellSize = std::max(options.positionTolerance, 1e-6f);
+    float tolerance2 = options.positionTolerance * options.positionTolerance;
+    float minNormalDot = std::cos(glm::radians(options.normalAngle));
+
+    // 21 bits per axis; wrapped cells only share a chain, the distance test stays exact
+    auto cellKey = [](int64_t x, int64_t y, int64_t z)
+    {
+        return ((uint64_t)(x & 0x1FFFFF) << 42) | ((uint64_t)(y & 0x1FFFFF) << 21) | (uint64_t)(z & 0x1FFFFF);
+    };
+    auto matches = [&](const Vertex &a, const Vertex &b)
+    {
+        glm::vec3 d = a.position - b.position;
+        if (glm::dot(d, d) > tolerance2)
+            return false;
+        glm::vec3 dc = glm::abs(a.color - b.color);
+        if (std::max(dc.x, std::max(dc.y, dc.z)) > options.colorTolerance)
+            return false;
+        float la = glm::length(a.normal), lb = glm::length(b.normal);
+        if (la == 0.0f || lb == 0.0f)
+            return la == lb;
+        return glm::dot(a.normal, b.normal) >= minNormalDot * la * lb;
+    };
+
+    // cell -> first kept vertex, chained through nextInCell
+    std::unordered_map<uint64_t, unsigned int> cells;
+    cells.reserve(vertices.size());
+    std::vector<unsigned int> nextInCell(vertices.size(), NONE);
+    std::vector<unsigned int> remap(vertices.size());
+    for (unsigned int v = 0; v < vertices.size(); ++v)
+    {
+        const glm::vec3 &p = vertices[v].position;
+        int64_t cx = (int64_t)std::floor(p.x / cellSize), cy = (int64_t)std::floor(p.y / cellSize), cz = (int64_t)std::floor(p.z / cellSize);
+        unsigned int found = NONE;
+        for (int dx = -1; dx <= 1 && found == NONE; ++dx)
+            for (int dy = -1; dy <= 1 && found == NONE; ++dy)
+                for (int dz = -1; dz <= 1 && found == NONE; ++dz)
+                {
+                    auto it = cells.find(cellKey(cx + dx, cy + dy, cz + dz));
+                    for (unsigned int u = (it != cells.end()) ? it->second : NONE; u != NONE; u = nextInCell[u])
+                    {
+                        if (matches(vertices[u], vertices[v]))
+                        {
+                            found = u;
+                            break;
+                        }
+                    }
+                }
+
+        if (found != NONE)
+        {
+            remap[v] = found;
+            continue;
+        }
+        remap[v] = v;
+        auto it = cells.emplace(cellKey(cx, cy, cz), v);
+        if (!it.second)
+        {
+            nextInCell[v] = it.first->second;
+            it.first->second = v;
+        }
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        unsigned int a = remap[indices[i]], b = remap[indices[i + 1]], c = remap[indices[i + 2]];
+        if (a == b || b == c || c == a)
+            continue;
+        glm::vec3 n = glm::cross(vertices[b].position - vertices[a].position, vertices[c].position - vertices[a].position);
+        if (glm::dot(n, n) <= tolerance2 * tolerance2)
+            continue;
+        indices[kept++] = a;
+        indices[kept++] = b;
+        indices[kept++] = c;
+    }
+    indices.resize(kept);
+
+    // compact to the referenced vertices, first use order
+    std::vector<unsigned int> compact(vertices.size(), NONE);
+    std::vector<Vertex> result;
+    for (unsigned int &index : indices)
+    {
+        if (compact[index] == NONE)
+        {
+            compact[index] = (unsigned int)result.size();
+            result.push_back(vertices[index]);
+        }
+        index = compact[index];
+    }
+    if (strips)
+    {
+        // strip-only references (degenerate pole triangles) still need a vertex
+        for (unsigned int &index : *strips)
+        {
+            if (index == RESTART_INDEX)
+                continue;
+            unsigned int v = remap[index];
+            if (compact[v] == NONE)
+            {
+                compact[v] = (unsigned int)result.size();
+                result.push_back(vertices[v]);
+            }
+            index = compact[v];
+        }
+    }
+
+    vertices.swap(result);
+    return vertices.size();
+}
+
+// Linear-speed vertex cache optimization (Forsyth). Greedily emits the
+// triangle with the best score, where recently used vertices and vertices
+// with few remaining triangles score higher. indices must be a triangle list;
+// a length that isn't a multiple of 3 leaves them unchanged.
+void optimizeVertexCache(std::vector<unsigned int> &indices, size_t vertexCount)
+{
+    PROFILE_SCOPE("optimizeVertexCache");
+    const int CACHE_SIZE = 32;
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || indices.size() % 3 != 0)
+        return;
+
+    auto vertexScore = [&](int cachePosition, unsigned int liveTriangles)
+    {
+        if (liveTriangles == 0)
+            return -1.0f;
+
+        float score = 0.0f;
+        if (cachePosition >= 0)
+        {
+            // the last triangle's vertices get a fixed score so the strip doesn't double back
+            if (cachePosition < 3)
+                score = 0.75f;
+            else
+                score = std::pow(1.0f - (float)(cachePosition - 3) / (CACHE_SIZE - 3), 1.5f);
+        }
+        // boost vertices with few triangles left so they don't get stranded
+        return score + 2.0f / std::sqrt((float)liveTriangles);
+    };
+
+    // vertex -> triangles adjacency in one flat array
+    std::vector<unsigned int> liveCount(vertexCount, 0);
+    for (unsigned int index : indices)
+        liveCount[index]++;
+
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v)
+        offsets[v + 1] = offsets[v] + liveCount[v];
+
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; ++t)
+        for (int k = 0; k < 3; ++k)
+            adjacency[fill[indices[t * 3 + k]]++] = (unsigned int)t;
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> scores(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+        scores[v] = vertexScore(-1, liveCount[v]);
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+
+    std::vector<unsigned int> cache, nextCache;
+    size_t inputCursor = 0;
+    int best = -1;
+
+    while (result.size() < indices.size())
+    {
+        // nothing adjacent to the cache is left, restart from the next unused triangle
+        if (best < 0)
+        {
+            while (emitted[inputCursor])
+                inputCursor++;
+            best = (int)inputCursor;
+        }
+
+        const unsigned int *tri = &indices[best * 3];
+        emitted[best] = true;
+
+        nextCache.assign(tri, tri + 3);
+        for (int k = 0; k < 3; ++k)
+        {
+            unsigned int v = tri[k];
+            result.push_back(v);
+
+            // remove the triangle from the vertex's live list
+            unsigned int *begin = &adjacency[offsets[v]];
+            unsigned int *end = begin + liveCount[v];
+            *std::find(begin, end, (unsigned int)best) = *(end - 1);
+            liveCount[v]--;
+        }
+        for (unsigned int v : cache)
+            if (v != tri[0] && v != tri[1] && v != tri[2])
+                nextCache.push_back(v);
+
+        // vertices pushed past the end fall out of the cache
+        for (size_t i = CACHE_SIZE; i < nextCache.size(); ++i)
+        {
+            cachePosition[nextCache[i]] = -1;
+            scores[nextCache[i]] = vertexScore(-1, liveCount[nextCache[i]]);
+        }
+        if (nextCache.size() > (size_t)CACHE_SIZE)
+            nextCache.resize(CACHE_SIZE);
+        cache.swap(nextCache);
+
+        for (size_t i = 0; i < cache.size(); ++i)
+        {
+            unsigned int v = cache[i];
+            cachePosition[v] = (int)i;
+            scores[v] = vertexScore((int)i, liveCount[v]);
+        }
+
+        // only triangles touching the cache changed score
+        best = -1;
+        float bestScore = -1.0f;
+        for (unsigned int v : cache)
+        {
+            for (unsigned int a = offsets[v]; a < offsets[v] + liveCount[v]; ++a)
+            {
+                unsigned int t = adjacency[a];
+                float score = scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    best = (int)t;
+                }
+            }
+        }
+    }
+
+    indices.swap(result);
+}
+
+// Overdraw pass in the spirit of Tipsify: the cache-optimized order is cut into
+// clusters wherever the simulated cache starts over, and clusters facing away
+// from the mesh center (likely front-most, outer surfaces) are drawn first.
+// The new order is kept only if ACMR stays within threshold of the input.
+void optimizeOverdraw(std::vector<unsigned int> &indices, const std::vector<Vertex> &vertices, float threshold = 1.05f)
+{
+    PROFILE_SCOPE("optimizeOverdraw");
+    const int CACHE_SIZE = 16;
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2)
+        return;
+
+    // cluster boundaries: triangles where none of the three vertices were cached
+    std::vector<size_t> clusterStart;
+    std::vector<unsigned int> entered(vertices.size(), 0);
+    unsigned int time = CACHE_SIZE + 1;
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        int misses = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            unsigned int v = indices[t * 3 + k];
+            if (time - entered[v] > (unsigned int)CACHE_SIZE)
+            {
+                entered[v] = time++;
+                misses++;
+            }
+        }
+        if (misses == 3 || t == 0)
+            clusterStart.push_back(t);
+    }
+    if (clusterStart.size() < 2)
+        return;
+    clusterStart.push_back(triangleCount);
+
+    glm::vec3 meshCenter(0.0f);
+    float meshArea = 0.0f;
+
+    struct Cluster
+    {
+        size_t begin, end;
+        glm::vec3 center;
+        glm::vec3 normal;
+        float area;
+        float sortKey;
+    };
+    std::vector<Cluster> clusters;
+    for (size_t c = 0; c + 1 < clusterStart.size(); ++c)
+    {
+        Cluster cluster{clusterStart[c], clusterStart[c + 1], glm::vec3(0.0f), glm::vec3(0.0f), 0.0f, 0.0f};
+        for (size_t t = cluster.begin; t < cluster.end; ++t)
+        {
+            const glm::vec3 &a = vertices[indices[t * 3]].position;
+            const glm::vec3 &b = vertices[indices[t * 3 + 1]].position;
+            const glm::vec3 &c3 = vertices[indices[t * 3 + 2]].position;
+            glm::vec3 n = glm::cross(b - a, c3 - a); // length is twice the area
+            float area = glm::length(n) * 0.5f;
+            cluster.center += (a + b + c3) * (area / 3.0f);
+            cluster.normal += n;
+            cluster.area += area;
+        }
+        meshCenter += cluster.center;
+        meshArea += cluster.area;
+        if (cluster.area > 0.0f)
+            cluster.center /= cluster.area;
+        clusters.push_back(cluster);
+    }
+    if (meshArea > 0.0f)
+        meshCenter /= meshArea;
+
+    for (Cluster &cluster : clusters)
+    {
+        float len = glm::length(cluster.normal);
+        cluster.sortKey = (len > 0.0f) ? glm::dot(cluster.center - meshCenter, cluster.normal / len) : 0.0f;
+    }
+    std::stable_sort(clusters.begin(), clusters.end(),
+                     [](const Cluster &a, const Cluster &b)
+                     { return a.sortKey > b.sortKey; });
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    for (const Cluster &cluster : clusters)
+        result.insert(result.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+
+    float before = analyzeVertexCache(indices, vertices.size()).acmr;
+    float after = analyzeVertexCache(result, vertices.size()).acmr;
+    if (after <= before * threshold)
+        indices.swap(result);
+}
+
+// Reorders vertices by first use so fetches walk memory linearly. Applies the
+// same remap to an optional strip index list (restart indices are preserved).
+void optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices, std::vector<unsigned int> *strips = nullptr)
+{
+    PROFILE_SCOPE("optimizeVertexFetch");
+    std::vector<unsigned int> remap(vertices.size(), RESTART_INDEX);
+    std::vector<Vertex> result;
+    result.reserve(vertices.size());
+
+    for (unsigned int &index : indices)
+    {
+        if (remap[index] == RESTART_INDEX)
+        {
+            remap[index] = (unsigned int)result.size();
+            result.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    if (strips)
+    {
+        // strip-only references (degenerate triangles weldVertices dropped) go after the rest
+        for (unsigned int &index : *strips)
+        {
+            if (index == RESTART_INDEX)
+                continue;
+            if (remap[index] == RESTART_INDEX)
+            {
+                remap[index] = (unsigned int)result.size();
+                result.push_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+    }
+
+    vertices.swap(result);
+}
+
+// Full pass: weld, vertex cache, overdraw, vertex fetch. When label is
+// given the cache statistics before and after are printed.
+void optimizeMesh(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices,
+                  std::vector<unsigned int> *strips = nullptr, const char *label = nullptr)
+{
+    PROFILE_SCOPE("optimizeMesh");
+    if (indices.size() < 3)
+        return;
+
+    size_t vertexCountBefore = vertices.size();
+    size_t triangleCountBefore = indices.size() / 3;
+    VertexCacheStats before = analyzeVertexCache(indices, vertices.size());
+
+    weldVertices(vertices, indices, WeldOptions(), strips);
+    optimizeVertexCache(indices, vertices.size());
+    optimizeOverdraw(indices, vertices);
+    optimizeVertexFetch(vertices, indices, strips);
+
+    if (label)
+    {
+        VertexCacheStats after = analyzeVertexCache(indices, vertices.size());
+        std::cout << "[INFO] (OPT) " << label << ": ACMR " << before.acmr << " -> " << after.acmr
+                  << ", ATVR " << before.atvr << " -> " << after.atvr
+                  << ", vertices " << vertexCountBefore << " -> " << vertices.size()
+                  << ", degenerate triangles dropped " << triangleCountBefore - indices.size() / 3 << std::endl;
+    }
+}
+
+#endif
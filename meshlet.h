@@ -0,0 +1,290 @@
+#ifndef MESHLET_H
+#define MESHLET_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "mesh.h"
+#include "halfedge.h"
+#include "profiler.h"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// A run of triangles in the reordered index list with its culling bounds
+struct Meshlet
+{
+    unsigned int firstIndex;
+    unsigned int indexCount;
+    unsigned int vertexCount;
+    glm::vec3 center; // bounding sphere
+    float radius;
+    glm::vec3 coneAxis; // average facing direction
+    float coneCutoff;   // sine of the cone spread, 1 disables the backface test
+};
+
+// Per-frame counters for the cluster pass
+struct MeshletStats
+{
+    int tested = 0;
+    int backfacing = 0;
+    int offscreen = 0;
+    size_t submittedTriangles = 0;
+    size_t totalTriangles = 0;
+};
+
+// Splits a triangle list into clusters of at most MAX_VERTICES vertices and
+// MAX_TRIANGLES triangles. Clusters are grown greedily from a seed triangle,
+// always taking the neighbouring triangle that adds the fewest new vertices,
+// so they stay compact and their bounds tight. build() reorders the index list
+// so each cluster is a contiguous range; visible clusters are then drawn with
+// one glMultiDrawElements over the merged ranges.
+class MeshletSet
+{
+public:
+    static constexpr unsigned int MAX_VERTICES = 64;
+    static constexpr unsigned int MAX_TRIANGLES = 124;
+
+    std::vector<Meshlet> meshlets;
+    bool coneCulling = false; // only closed meshes can't show their back side
+
+    bool empty() const { return meshlets.empty(); }
+
+    void build(const std::vector<Vertex> &vertices, std::vector<unsigned int> &indices)
+    {
+        PROFILE_SCOPE("buildMeshlets");
+        const unsigned int NONE = 0xFFFFFFFF;
+        size_t triangleCount = indices.size() / 3;
+        meshlets.clear();
+        if (triangleCount == 0)
+            return;
+
+        // vertex -> triangles
+        std::vector<unsigned int> offsets(vertices.size() + 1, 0), adjacency(triangleCount * 3);
+        for (size_t i = 0; i < triangleCount * 3; ++i)
+            offsets[indices[i] + 1]++;
+        for (size_t v = 0; v < vertices.size(); ++v)
+            offsets[v + 1] += offsets[v];
+        std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; ++i)
+            adjacency[fill[indices[i]]++] = (unsigned int)(i / 3);
+
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<unsigned int> owner(vertices.size(), NONE); // meshlet that last used the vertex
+        std::vector<unsigned int> local;                       // vertices of the current meshlet
+        std::vector<unsigned int> ordered;
+        ordered.reserve(triangleCount * 3);
+
+        auto newVertices = [&](unsigned int t, unsigned int id)
+        {
+            return (owner[indices[t * 3]] != id) + (owner[indices[t * 3 + 1]] != id) + (owner[indices[t * 3 + 2]] != id);
+        };
+
+        // faces point out of a closed mesh when its signed volume is positive; loaded
+        // files come in either winding, so the cone normals follow the volume
+        coneCulling = isClosed(vertices, indices);
+        double volume = 0.0;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            const glm::vec3 &a = vertices[indices[i]].position, &b = vertices[indices[i + 1]].position, &c = vertices[indices[i + 2]].position;
+            volume += glm::dot(a, glm::cross(b, c));
+        }
+        float outward = (volume < 0.0) ? -1.0f : 1.0f;
+
+        size_t seed = 0;
+        while (true)
+        {
+            while (seed < triangleCount && emitted[seed])
+                seed++;
+            if (seed == triangleCount)
+                break;
+
+            unsigned int id = (unsigned int)meshlets.size();
+            Meshlet m{};
+            m.firstIndex = (unsigned int)ordered.size();
+            local.clear();
+
+            unsigned int t = (unsigned int)seed;
+            while (t != NONE)
+            {
+                emitted[t] = true;
+                for (int k = 0; k < 3; ++k)
+                {
+                    unsigned int v = indices[t * 3 + k];
+                    if (owner[v] != id)
+                    {
+                        owner[v] = id;
+                        local.push_back(v);
+                    }
+                    ordered.push_back(v);
+                }
+                if (ordered.size() - m.firstIndex >= MAX_TRIANGLES * 3)
+                    break;
+
+                // cheapest neighbour that still fits
+                unsigned int best = NONE, bestCost = 4;
+                for (unsigned int v : local)
+                {
+                    for (unsigned int a = offsets[v]; a < offsets[v + 1] && bestCost > 0; ++a)
+                    {
+                        unsigned int candidate = adjacency[a];
+                        if (emitted[candidate])
+                            continue;
+                        unsigned int cost = newVertices(candidate, id);
+                        if (cost < bestCost && local.size() + cost <= MAX_VERTICES)
+                        {
+                            best = candidate;
+                            bestCost = cost;
+                        }
+                    }
+                    if (bestCost == 0)
+                        break;
+                }
+                t = best;
+            }
+
+            m.indexCount = (unsigned int)ordered.size() - m.firstIndex;
+            m.vertexCount = (unsigned int)local.size();
+            computeBounds(m, vertices, ordered, local, outward);
+            meshlets.push_back(m);
+        }
+
+        indices.swap(ordered);
+    }
+
+    // Appends the visible clusters as merged (count, byte offset) ranges for
+    // glMultiDrawElements. The model transform is assumed to be rigid up to scale.
+    void cull(const glm::mat4 &viewProjection, const glm::mat4 &model, const glm::vec3 &cameraPosition, GLenum indexType,
+              std::vector<GLsizei> &counts, std::vector<const void *> &offsets, MeshletStats &stats) const
+    {
+        float scale = std::max({glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))});
+        size_t indexSize = (indexType == GL_UNSIGNED_SHORT) ? sizeof(uint16_t) : sizeof(uint32_t);
+
+        // world-space frustum planes (Gribb-Hartmann), normalized so sphere tests use true distances
+        glm::vec4 planes[6];
+        const glm::mat4 &vp = viewProjection;
+        glm::vec4 row0(vp[0][0], vp[1][0], vp[2][0], vp[3][0]);
+        glm::vec4 row1(vp[0][1], vp[1][1], vp[2][1], vp[3][1]);
+        glm::vec4 row2(vp[0][2], vp[1][2], vp[2][2], vp[3][2]);
+        glm::vec4 row3(vp[0][3], vp[1][3], vp[2][3], vp[3][3]);
+        planes[0] = row3 + row0;
+        planes[1] = row3 - row0;
+        planes[2] = row3 + row1;
+        planes[3] = row3 - row1;
+        planes[4] = row3 + row2;
+        planes[5] = row3 - row2;
+        for (glm::vec4 &p : planes)
+            p = p / glm::length(glm::vec3(p));
+
+        unsigned int runStart = 0, runEnd = 0; // pending merged range, in indices
+        auto flush = [&]()
+        {
+            if (runEnd > runStart)
+            {
+                counts.push_back((GLsizei)(runEnd - runStart));
+                offsets.push_back(reinterpret_cast<const void *>(runStart * indexSize));
+            }
+        };
+
+        for (const Meshlet &m : meshlets)
+        {
+            stats.tested++;
+            stats.totalTriangles += m.indexCount / 3;
+
+            glm::vec3 center = glm::vec3(model * glm::vec4(m.center, 1.0f));
+            float radius = m.radius * scale;
+
+            bool outside = false;
+            for (const glm::vec4 &p : planes)
+            {
+                if (glm::dot(glm::vec3(p), center) + p.w < -radius)
+                {
+                    outside = true;
+                    break;
+                }
+            }
+            if (outside)
+            {
+                stats.offscreen++;
+                continue;
+            }
+
+            if (coneCulling && m.coneCutoff < 1.0f)
+            {
+                glm::vec3 axis = glm::normalize(glm::vec3(model * glm::vec4(m.coneAxis, 0.0f)));
+                glm::vec3 view = center - cameraPosition;
+                if (glm::dot(view, axis) >= m.coneCutoff * glm::length(view) + radius)
+                {
+                    stats.backfacing++;
+                    continue;
+                }
+            }
+
+            stats.submittedTriangles += m.indexCount / 3;
+            if (m.firstIndex != runEnd)
+            {
+                flush();
+                runStart = m.firstIndex;
+            }
+            runEnd = m.firstIndex + m.indexCount;
+        }
+        flush();
+    }
+
+private:
+    static void computeBounds(Meshlet &m, const std::vector<Vertex> &vertices, const std::vector<unsigned int> &ordered,
+                              const std::vector<unsigned int> &local, float outward)
+    {
+        glm::vec3 lo = vertices[local[0]].position, hi = lo;
+        for (unsigned int v : local)
+        {
+            lo = glm::min(lo, vertices[v].position);
+            hi = glm::max(hi, vertices[v].position);
+        }
+        m.center = (lo + hi) * 0.5f;
+        m.radius = 0.0f;
+        for (unsigned int v : local)
+            m.radius = std::max(m.radius, glm::length(vertices[v].position - m.center));
+
+        std::vector<glm::vec3> normals;
+        glm::vec3 sum(0.0f);
+        for (unsigned int i = m.firstIndex; i < m.firstIndex + m.indexCount; i += 3)
+        {
+            const glm::vec3 &a = vertices[ordered[i]].position, &b = vertices[ordered[i + 1]].position, &c = vertices[ordered[i + 2]].position;
+            glm::vec3 n = glm::cross(b - a, c - a);
+            float len = glm::length(n);
+            if (len == 0.0f)
+                continue;
+            n *= outward / len;
+            normals.push_back(n);
+            sum += n;
+        }
+
+        m.coneAxis = glm::vec3(0.0f, 1.0f, 0.0f);
+        m.coneCutoff = 1.0f;
+        float len = glm::length(sum);
+        if (normals.empty() || len < 1e-6f)
+            return;
+        m.coneAxis = sum / len;
+        float minDot = 1.0f;
+        for (const glm::vec3 &n : normals)
+            minDot = std::min(minDot, glm::dot(n, m.coneAxis));
+        // spreads past ~84 degrees can always show a front face
+        m.coneCutoff = (minDot <= 0.1f) ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+    }
+
+    // every edge shared by exactly two faces once positions are welded
+    static bool isClosed(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices)
+    {
+        HalfEdgeMesh he;
+        he.build(vertices, indices, true);
+        if (!he.isManifold())
+            return false;
+        for (unsigned int t : he.twin)
+            if (t == HalfEdgeMesh::INVALID)
+                return false;
+        return true;
+    }
+};
+
+#endif
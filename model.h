@@ -8,26 +8,76 @@
 
 #include <mesh.h>
 #include <shader.h>
+#include <mesh_optimizer.h>
+#include <subdivision.h>
+#include <meshlet.h>
+#include <profiler.h>
 
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include <iostream>
 
+// Union-find with path halving and union by size
+struct DisjointSet
+{
+    std::vector<unsigned int> parent;
+    std::vector<unsigned int> size;
+
+    DisjointSet(size_t count) : parent(count), size(count, 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+            parent[i] = (unsigned int)i;
+    }
+
+    unsigned int find(unsigned int x)
+    {
+        while (parent[x] != x)
+        {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+
+    void unite(unsigned int a, unsigned int b)
+    {
+        a = find(a);
+        b = find(b);
+        if (a == b)
+            return;
+        if (size[a] < size[b])
+            std::swap(a, b);
+        parent[b] = a;
+        size[a] += size[b];
+    }
+};
+
+struct ModelLoadOptions
+{
+    int subdivisionLevels = 0;   // > 0 refines the control mesh (Loop or Catmull-Clark)
+    bool splitComponents = false; // one mesh per connected part instead of one for the file
+    size_t smallPartTriangles = 0; // split parts below this go into one shared batch mesh
+    bool buildMeshlets = false;   // cluster meshes big enough for per-cluster culling
+};
+
 class Model
 {
 public:
     std::vector<Mesh> meshes;
+    std::vector<MeshletSet> meshlets; // one per mesh, empty unless buildMeshlets and the mesh is large
 
-    Model(const std::string &path, glm::vec3 color = glm::vec3(1.0f))
+    Model(const std::string &path, glm::vec3 color = glm::vec3(1.0f), const ModelLoadOptions &options = ModelLoadOptions())
     {
-        if (!loadOFF(path, color))
+        if (!loadOFF(path, color, options))
         {
             std::cerr << "[ERROR] (MODEL) Failed to load OFF: " << path << std::endl;
         }
     }
 
-    bool loadOFF(const std::string &path, glm::vec3 color)
+    bool loadOFF(const std::string &path, glm::vec3 color, const ModelLoadOptions &options = ModelLoadOptions())
     {
+        PROFILE_SCOPE("loadOFF");
         std::vector<Vertex> vertices;
         std::vector<unsigned int> indices;
 
@@ -55,6 +105,7 @@ public:
         }
 
         size_t numVertices = 0, numFaces = 0, numEdges = 0;
+        std::vector<unsigned int> triangleSource; // an OFF vertex of the face each triangle came from
         while (true)
         {
             if (!in.good())
@@ -122,6 +173,8 @@ public:
             vertices.push_back(v);
         }
 
+        // faces sharing an OFF vertex belong to the same part
+        DisjointSet parts(numVertices);
         for (int i = 0; i < numFaces; i++)
         {
             std::string line;
@@ -167,6 +220,9 @@ public:
                 }
             }
 
+            for (int k = 1; k < vn; ++k)
+                parts.unite(faceIdx[0], faceIdx[k]);
+
             glm::vec3 normal = glm::normalize(glm::cross(vertices[faceIdx[2]].position - vertices[faceIdx[0]].position, vertices[faceIdx[1]].position - vertices[faceIdx[0]].position));
 
             glm::vec3 faceColor = color;
@@ -198,14 +254,74 @@ public:
                 indices.push_back(baseVertexIndex);
                 indices.push_back(baseVertexIndex + k);
                 indices.push_back(baseVertexIndex + k + 1);
+                triangleSource.push_back(faceIdx[0]);
             }
         }
 
         meshes.clear();
-        meshes.emplace_back(vertices, indices);
+        meshlets.clear();
+        if (!options.splitComponents)
+        {
+            addMesh(vertices, indices, options, path.c_str());
+            return true;
+        }
+
+        // group triangles by part, in file order
+        const unsigned int NO_PART = 0xFFFFFFFF;
+        std::vector<unsigned int> partOf(numVertices, NO_PART);
+        std::vector<std::vector<unsigned int>> partTriangles;
+        for (size_t t = 0; t < triangleSource.size(); ++t)
+        {
+            unsigned int root = parts.find(triangleSource[t]);
+            if (partOf[root] == NO_PART)
+            {
+                partOf[root] = (unsigned int)partTriangles.size();
+                partTriangles.emplace_back();
+            }
+            partTriangles[partOf[root]].push_back((unsigned int)t);
+        }
+
+        std::vector<Vertex> smallVertices;
+        std::vector<unsigned int> smallIndices;
+        size_t smallParts = 0;
+        for (const std::vector<unsigned int> &triangles : partTriangles)
+        {
+            std::vector<Vertex> partVertices;
+            std::vector<unsigned int> partIndices;
+            bool small = triangles.size() < options.smallPartTriangles;
+            extractTriangles(vertices, indices, triangles, small ? smallVertices : partVertices, small ? smallIndices : partIndices);
+            if (small)
+                smallParts++;
+            else
+                addMesh(partVertices, partIndices, options, nullptr);
+        }
+        if (!smallIndices.empty())
+            addMesh(smallVertices, smallIndices, options, nullptr);
+
+        std::cout << "[INFO] (MODEL) " << path << ": " << partTriangles.size() << " parts, "
+                  << smallParts << " small ones batched, " << meshes.size() << " meshes" << std::endl;
         return true;
     }
 
+    // Appends the given triangles (indices of triangles in indices) with their own vertices
+    static void extractTriangles(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices,
+                                 const std::vector<unsigned int> &triangles,
+                                 std::vector<Vertex> &outVertices, std::vector<unsigned int> &outIndices)
+    {
+        std::unordered_map<unsigned int, unsigned int> remap;
+        for (unsigned int t : triangles)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                unsigned int index = indices[t * 3 + k];
+                auto it = remap.emplace(index, (unsigned int)outVertices.size());
+                if (it.second)
+                    outVertices.push_back(vertices[index]);
+                outIndices.push_back(it.first->second);
+            }
+        }
+    }
+
     void draw(Shader &shader, bool drawEdges = false)
     {
         for (Mesh &m : meshes)
@@ -215,6 +331,21 @@ public:
                 m.drawEdges(shader);
         }
     }
+
+private:
+    void addMesh(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices, const ModelLoadOptions &options, const char *label)
+    {
+        subdivideMesh(vertices, indices, options.subdivisionLevels, label);
+
+        // faces own their vertices, so reorder for the post-transform cache before upload
+        optimizeMesh(vertices, indices, nullptr, label);
+
+        // clusters reorder the triangles, so they have to be built before upload
+        meshlets.emplace_back();
+        if (options.buildMeshlets && indices.size() / 3 >= 2 * MeshletSet::MAX_TRIANGLES)
+            meshlets.back().build(vertices, indices);
+        meshes.emplace_back(vertices, indices);
+    }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,262 @@
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+#include <glm/glm.hpp>
+#include "mesh.h"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Per-frame counters for the occlusion pass
+struct OcclusionStats
+{
+    int tested = 0;
+    int occluded = 0;
+    int offscreen = 0;
+    int occluderTriangles = 0;
+
+    int rejected() const { return occluded + offscreen; }
+};
+
+// CPU occlusion culling against a coarse software depth buffer.
+// A handful of large occluders are rasterized into the buffer every frame, then
+// object bounds are tested against it before their draw is submitted.
+// Depth is stored as window-space z in [0, 1] (1 = far plane).
+class OcclusionCuller
+{
+public:
+    OcclusionCuller(int width = 256, int height = 128)
+        : width((width + 3) & ~3), height(height), viewProjection(1.0f)
+    {
+        depth.resize(this->width * this->height, 1.0f);
+    }
+
+    void beginFrame(const glm::mat4 &viewProj)
+    {
+        viewProjection = viewProj;
+        std::fill(depth.begin(), depth.end(), 1.0f);
+        stats = OcclusionStats();
+    }
+
+    void addOccluder(const Mesh &mesh, const glm::mat4 &model)
+    {
+        glm::mat4 mvp = viewProjection * model;
+
+        clipVertices.resize(mesh.vertices.size());
+        for (size_t i = 0; i < mesh.vertices.size(); ++i)
+            clipVertices[i] = mvp * glm::vec4(mesh.vertices[i].position, 1.0f);
+
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+        {
+            const glm::vec4 &a = clipVertices[mesh.indices[i]];
+            const glm::vec4 &b = clipVertices[mesh.indices[i + 1]];
+            const glm::vec4 &c = clipVertices[mesh.indices[i + 2]];
+            rasterizeClipped(a, b, c);
+            stats.occluderTriangles++;
+        }
+    }
+
+    // Tests a local-space box; returns false if the draw can be skipped
+    bool isVisible(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax, const glm::mat4 &model)
+    {
+        stats.tested++;
+
+        glm::mat4 mvp = viewProjection * model;
+
+        float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
+        float minZ = 1e30f; // nearest corner, beyond 1 when the box is past the far plane
+        for (int i = 0; i < 8; ++i)
+        {
+            glm::vec3 corner((i & 1) ? boundsMax.x : boundsMin.x,
+                             (i & 2) ? boundsMax.y : boundsMin.y,
+                             (i & 4) ? boundsMax.z : boundsMin.z);
+            glm::vec4 clip = mvp * glm::vec4(corner, 1.0f);
+
+            // box crosses the near plane, can't say anything useful
+            if (clip.w <= NEAR_W)
+                return true;
+
+            glm::vec3 s = toScreen(clip);
+            minX = std::min(minX, s.x);
+            maxX = std::max(maxX, s.x);
+            minY = std::min(minY, s.y);
+            maxY = std::max(maxY, s.y);
+            minZ = std::min(minZ, s.z);
+        }
+
+        if (maxX < 0.0f || maxY < 0.0f || minX > width || minY > height || minZ > 1.0f)
+        {
+            stats.offscreen++;
+            return false;
+        }
+
+        // grow the rect by a pixel so partially covered occluder edges can't hide it
+        int x0 = std::max(0, (int)std::floor(minX) - 1);
+        int x1 = std::min(width - 1, (int)maxX + 1);
+        int y0 = std::max(0, (int)std::floor(minY) - 1);
+        int y1 = std::min(height - 1, (int)maxY + 1);
+
+        // visible as soon as one pixel in the rect isn't closer than the box
+        for (int y = y0; y <= y1; ++y)
+        {
+            const float *row = &depth[y * width];
+            int x = x0;
+#ifdef __SSE2__
+            __m128 zv = _mm_set1_ps(minZ);
+            for (; x + 3 <= x1; x += 4)
+            {
+                __m128 d = _mm_loadu_ps(row + x);
+                if (_mm_movemask_ps(_mm_cmpge_ps(d, zv)) != 0)
+                    return true;
+            }
+#endif
+            for (; x <= x1; ++x)
+            {
+                if (row[x] >= minZ)
+                    return true;
+            }
+        }
+
+        stats.occluded++;
+        return false;
+    }
+
+    const OcclusionStats &getStats() const { return stats; }
+
+private:
+    static constexpr float NEAR_W = 1e-3f;
+
+    int width, height;
+    std::vector<float> depth;
+    std::vector<glm::vec4> clipVertices;
+    glm::mat4 viewProjection;
+    OcclusionStats stats;
+
+    glm::vec3 toScreen(const glm::vec4 &clip) const
+    {
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        return glm::vec3((ndc.x * 0.5f + 0.5f) * width,
+                         (ndc.y * 0.5f + 0.5f) * height,
+                         ndc.z * 0.5f + 0.5f);
+    }
+
+    // clip against the near plane (w > NEAR_W) and rasterize the resulting fan
+    void rasterizeClipped(const glm::vec4 &a, const glm::vec4 &b, const glm::vec4 &c)
+    {
+        const glm::vec4 in[3] = {a, b, c};
+        glm::vec4 out[4];
+        int count = 0;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            const glm::vec4 &p = in[i];
+            const glm::vec4 &q = in[(i + 1) % 3];
+            bool pIn = p.w > NEAR_W;
+            bool qIn = q.w > NEAR_W;
+
+            if (pIn)
+                out[count++] = p;
+            if (pIn != qIn)
+            {
+                float t = (NEAR_W - p.w) / (q.w - p.w);
+                out[count++] = p + (q - p) * t;
+            }
+        }
+
+        if (count < 3)
+            return;
+
+        glm::vec3 s0 = toScreen(out[0]);
+        for (int i = 1; i + 1 < count; ++i)
+            rasterizeTriangle(s0, toScreen(out[i]), toScreen(out[i + 1]));
+    }
+
+    // Pixels are sampled at their centers and written with the triangle's farthest
+    // depth, so the buffer never puts an occluder closer than it really is.
+    void rasterizeTriangle(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2)
+    {
+        float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+        if (area == 0.0f)
+            return;
+        if (area < 0.0f)
+            std::swap(v1, v2);
+
+        int x0 = std::max(0, (int)std::floor(std::min({v0.x, v1.x, v2.x})));
+        int x1 = std::min(width - 1, (int)std::ceil(std::max({v0.x, v1.x, v2.x})));
+        int y0 = std::max(0, (int)std::floor(std::min({v0.y, v1.y, v2.y})));
+        int y1 = std::min(height - 1, (int)std::ceil(std::max({v0.y, v1.y, v2.y})));
+        if (x0 > x1 || y0 > y1)
+            return;
+
+        float z = std::min(1.0f, std::max({v0.z, v1.z, v2.z}));
+
+        // edge equations E(x, y) = A * x + B * y + C, inside when E >= 0
+        const glm::vec3 *v[3] = {&v0, &v1, &v2};
+        float A[3], B[3], C[3];
+        for (int e = 0; e < 3; ++e)
+        {
+            const glm::vec3 &p = *v[e];
+            const glm::vec3 &q = *v[(e + 1) % 3];
+            A[e] = p.y - q.y;
+            B[e] = q.x - p.x;
+            C[e] = -A[e] * p.x - B[e] * p.y;
+        }
+
+        x0 &= ~3;
+
+#ifdef __SSE2__
+        __m128 zv = _mm_set1_ps(z);
+        __m128 zero = _mm_setzero_ps();
+        __m128 stepA[3], offsetX = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+        for (int e = 0; e < 3; ++e)
+            stepA[e] = _mm_set1_ps(A[e] * 4.0f);
+
+        for (int y = y0; y <= y1; ++y)
+        {
+            float py = y + 0.5f;
+            __m128 E[3];
+            for (int e = 0; e < 3; ++e)
+            {
+                __m128 px = _mm_add_ps(_mm_set1_ps((float)x0), offsetX);
+                E[e] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A[e]), px), _mm_set1_ps(B[e] * py + C[e]));
+            }
+
+            float *row = &depth[y * width];
+            for (int x = x0; x <= x1; x += 4)
+            {
+                __m128 mask = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(E[0], zero), _mm_cmpge_ps(E[1], zero)),
+                                         _mm_cmpge_ps(E[2], zero));
+                if (_mm_movemask_ps(mask) != 0)
+                {
+                    __m128 d = _mm_loadu_ps(row + x);
+                    __m128 nd = _mm_min_ps(d, zv);
+                    _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(mask, nd), _mm_andnot_ps(mask, d)));
+                }
+                for (int e = 0; e < 3; ++e)
+                    E[e] = _mm_add_ps(E[e], stepA[e]);
+            }
+        }
+#else
+        for (int y = y0; y <= y1; ++y)
+        {
+            float py = y + 0.5f;
+            float *row = &depth[y * width];
+            for (int x = x0; x <= x1; ++x)
+            {
+                float px = x + 0.5f;
+                if (A[0] * px + B[0] * py + C[0] >= 0.0f &&
+                    A[1] * px + B[1] * py + C[1] >= 0.0f &&
+                    A[2] * px + B[2] * py + C[2] >= 0.0f)
+                    row[x] = std::min(row[x], z);
+            }
+        }
+#endif
+    }
+};
+
+#endif
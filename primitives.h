@@ -2,6 +2,8 @@
 #define PRIMITIVES_H
 
 #include <mesh.h>
+#include <mesh_optimizer.h>
+#include <profiler.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
 #include <vector>
@@ -9,6 +11,7 @@
 
 Mesh createCube(float size = 1.0f, glm::vec3 color = glm::vec3(1.0f))
 {
+    PROFILE_SCOPE("createCube");
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
 
@@ -67,6 +70,7 @@ Mesh createCube(float size = 1.0f, glm::vec3 color = glm::vec3(1.0f))
 
 Mesh createCylinder(float radius = 0.5f, float height = 1.0f, int segments = 32, glm::vec3 color = glm::vec3(1.0f))
 {
+    PROFILE_SCOPE("createCylinder");
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
 
@@ -144,6 +148,7 @@ Mesh createCylinder(float radius = 0.5f, float height = 1.0f, int segments = 32,
 
 Mesh createCone(float radius = 0.5f, float height = 1.0f, int segments = 32, glm::vec3 color = glm::vec3(1.0f))
 {
+    PROFILE_SCOPE("createCone");
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
 
@@ -196,10 +201,13 @@ Mesh createCone(float radius = 0.5f, float height = 1.0f, int segments = 32, glm
     return Mesh(vertices, indices);
 }
 
-Mesh createSphere(float radius = 0.5f, int stacks = 16, int slices = 32, glm::vec3 color = glm::vec3(1.0f))
+// strips: also build one restart-separated triangle strip per stack for drawing
+Mesh createSphere(float radius = 0.5f, int stacks = 16, int slices = 32, glm::vec3 color = glm::vec3(1.0f), bool strips = false)
 {
+    PROFILE_SCOPE("createSphere");
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
+    std::vector<unsigned int> stripIndices;
 
     for (int i = 0; i <= stacks; i++)
     {
@@ -238,13 +246,19 @@ Mesh createSphere(float radius = 0.5f, int stacks = 16, int slices = 32, glm::ve
             indices.push_back(p2);
             indices.push_back(p3);
         }
+
+        if (strips)
+            appendStripRow(stripIndices, i * (slices + 1), (i + 1) * (slices + 1), slices + 1);
     }
 
-    return Mesh(vertices, indices);
+    // the seam column and the pole rings are coincident copies
+    weldVertices(vertices, indices, WeldOptions(), &stripIndices);
+    return Mesh(vertices, indices, stripIndices);
 }
 
 Mesh createPlane(float width = 1.0f, float depth = 1.0f, glm::vec3 color = glm::vec3(1.0f))
 {
+    PROFILE_SCOPE("createPlane");
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
 
@@ -272,10 +286,13 @@ Mesh createPlane(float width = 1.0f, float depth = 1.0f, glm::vec3 color = glm::
 
 // mainRadius: dist from center to the middle of the tube
 // tubeRadius: radius of the tube itself
-Mesh createTorus(float mainRadius = 1.0f, float tubeRadius = 0.2f, int mainSegments = 32, int tubeSegments = 16, glm::vec3 color = glm::vec3(1.0f))
+// strips: also build one triangle strip per main segment for drawing
+Mesh createTorus(float mainRadius = 1.0f, float tubeRadius = 0.2f, int mainSegments = 32, int tubeSegments = 16, glm::vec3 color = glm::vec3(1.0f), bool strips = false)
 {
+    PROFILE_SCOPE("createTorus");
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
+    std::vector<unsigned int> stripIndices;
 
     for (int i = 0; i <= mainSegments; i++)
     {
@@ -319,13 +336,19 @@ Mesh createTorus(float mainRadius = 1.0f, float tubeRadius = 0.2f, int mainSegme
             indices.push_back(next + 1);
             indices.push_back(current + 1);
         }
+
+        if (strips)
+            appendStripRow(stripIndices, i * (tubeSegments + 1), (i + 1) * (tubeSegments + 1), tubeSegments + 1);
     }
 
-    return Mesh(vertices, indices);
+    // closing ring and closing tube column are coincident copies
+    weldVertices(vertices, indices, WeldOptions(), &stripIndices);
+    return Mesh(vertices, indices, stripIndices);
 }
 
 Mesh createCylinderSector(float radius = 0.5f, float height = 1.0f, float sweepAngle = 360.0f, int segments = 32, glm::vec3 color = glm::vec3(1.0f))
 {
+    PROFILE_SCOPE("createCylinderSector");
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
 
@@ -0,0 +1,432 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+// One timed scope, times in ns since the profiler was created
+struct ProfileEvent
+{
+    const char *name; // a string literal, never copied
+    uint64_t start;
+    uint64_t end;
+};
+
+// A phase over the stats window; times are per frame (all calls summed)
+struct PhaseStats
+{
+    std::string name;
+    double meanMs;
+    double maxMs;
+    float callsPerFrame;
+};
+
+// Scoped CPU timers. PROFILE_SCOPE("name") times the rest of the enclosing
+// block into a ring owned by the calling thread, so worker threads never
+// contend; the main thread drains every ring in endFrame() and folds the
+// events into per-phase statistics over the last WINDOW frames. While
+// disabled a scope costs one relaxed atomic load.
+//
+// captureTrace() also keeps the raw events of a range of frames and writes
+// them as Chrome trace JSON (chrome://tracing, Perfetto) after the last one.
+// GPU times (gpu_profiler.h) come in through recordGpu() and are shown as
+// "gpu <name>" phases and on their own trace track.
+class Profiler
+{
+public:
+    static const int WINDOW = 120;
+
+    static Profiler &instance()
+    {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    static bool enabled() { return active.load(std::memory_order_relaxed); }
+
+    void setEnabled(bool on)
+    {
+        if (on && !enabled())
+        {
+            // drop whatever was left from an earlier session
+            drainRings();
+            pending.clear();
+            phases.clear();
+            frameMs.assign(WINDOW, 0.0f);
+            windowFrames = 0;
+            frameStart = now(); // when switched on mid-frame
+        }
+        traceOnly = false;
+        active.store(on, std::memory_order_relaxed);
+    }
+
+    static uint64_t now()
+    {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - instance().epoch).count();
+    }
+
+    // Called by ProfileScope from any thread
+    void record(const ProfileEvent &event)
+    {
+        thread_local RingHandle handle;
+        if (!handle.ring)
+            handle.ring = acquireRing();
+        handle.ring->push(event);
+    }
+
+    // A GPU interval already converted to profiler time; main thread only.
+    // It lands in the frame it is delivered in, a few frames after it ran.
+    void recordGpu(const char *name, uint64_t start, uint64_t end)
+    {
+        if (enabled())
+            pending.push_back({{name, start, end}, GPU_TRACK});
+    }
+
+    void beginFrame()
+    {
+        if (!enabled())
+            return;
+        // work between frames (loading, callbacks) shows in traces but not in the stats
+        drainRings();
+        if (tracing(frame))
+            keepForTrace();
+        pending.clear();
+        frameStart = now();
+    }
+
+    void endFrame()
+    {
+        if (enabled())
+        {
+            uint64_t frameEnd = now();
+            drainRings();
+            accumulate(frameEnd - frameStart);
+            if (tracing(frame))
+            {
+                keepForTrace();
+                trace.push_back({{"frame", frameStart, frameEnd}, mainThread});
+                if (frame == traceLast)
+                    writeTrace();
+            }
+            pending.clear();
+        }
+        frame++;
+    }
+
+    long long frameIndex() const { return frame; }
+
+    // Traces frames [first, first + count); count <= 0 traces until finish().
+    // Turns the profiler on for the capture.
+    void captureTrace(const std::string &path, long long first, long long count)
+    {
+        bool wasEnabled = enabled();
+        setEnabled(true);
+        traceOnly = !wasEnabled;
+        tracePath = path;
+        traceFirst = std::max(first, frame);
+        traceLast = count > 0 ? traceFirst + count - 1 : -1;
+        trace.clear();
+        std::cout << "[INFO] (PROFILE) tracing frames " << traceFirst << "-"
+                  << (traceLast >= 0 ? std::to_string(traceLast) : std::string("end")) << " to " << path << std::endl;
+    }
+
+    bool capturing() const { return !tracePath.empty(); }
+
+    // Writes a trace still in progress
+    void finish()
+    {
+        if (capturing())
+            writeTrace();
+    }
+
+    // Phases of the window, slowest first; the first entry is the whole CPU frame
+    std::vector<PhaseStats> stats() const
+    {
+        std::vector<PhaseStats> result;
+        int frames = std::min(windowFrames, WINDOW);
+        if (frames == 0)
+            return result;
+        result.push_back(summarize("frame", frameMs, std::vector<uint16_t>(WINDOW, 1), frames));
+        std::vector<PhaseStats> sorted;
+        for (const auto &entry : phases)
+        {
+            PhaseStats phase = summarize(entry.first, entry.second.ms, entry.second.calls, frames);
+            if (phase.callsPerFrame > 0.0f)
+                sorted.push_back(phase);
+        }
+        // CPU phases, then GPU ones, each slowest first
+        std::sort(sorted.begin(), sorted.end(), [](const PhaseStats &a, const PhaseStats &b)
+                  { return isGpu(a.name) != isGpu(b.name) ? isGpu(b.name) : a.meanMs > b.meanMs; });
+        result.insert(result.end(), sorted.begin(), sorted.end());
+        return result;
+    }
+
+    void printStats() const
+    {
+        std::vector<PhaseStats> phaseStats = stats();
+        if (phaseStats.empty())
+            return;
+        double frameMean = std::max(phaseStats[0].meanMs, 1e-9);
+        std::cout << "[INFO] (PROFILE) " << std::left << std::setw(LABEL_WIDTH) << "last " + std::to_string(std::min(windowFrames, WINDOW)) + " frames"
+                  << std::right << "   mean ms    max ms  frame %  calls" << std::endl;
+        for (size_t i = 0; i < phaseStats.size(); ++i)
+        {
+            const PhaseStats &p = phaseStats[i];
+            std::string label = (i == 0 ? "" : "  ") + p.name;
+            std::cout << "[INFO] (PROFILE) " << std::left << std::setw(LABEL_WIDTH) << label << std::right << std::fixed
+                      << std::setprecision(3) << std::setw(10) << p.meanMs << std::setw(10) << p.maxMs
+                      << std::setprecision(1) << std::setw(9) << 100.0 * p.meanMs / frameMean
+                      << std::setprecision(1) << std::setw(7) << p.callsPerFrame << std::defaultfloat << std::endl;
+        }
+
+        // the GPU busy for most of the frame time means the frame waits on rasterization
+        for (const PhaseStats &p : phaseStats)
+        {
+            if (p.name != GPU_PREFIX + std::string("frame"))
+                continue;
+            double busy = p.meanMs / frameMean;
+            std::cout << "[INFO] (PROFILE) GPU busy " << std::fixed << std::setprecision(0) << 100.0 * busy
+                      << "% of the frame: " << (busy > GPU_BOUND_SHARE ? "GPU-bound" : "CPU-bound") << std::defaultfloat << std::endl;
+        }
+    }
+
+private:
+    // Single-producer ring: the owning thread pushes, the main thread drains.
+    // Drained every frame, far more often than it can fill.
+    struct Ring
+    {
+        static const size_t CAPACITY = 1 << 14;
+
+        explicit Ring(uint32_t id) : id(id), events(CAPACITY) {}
+
+        void push(const ProfileEvent &event)
+        {
+            uint64_t h = head.load(std::memory_order_relaxed);
+            events[h & (CAPACITY - 1)] = event;
+            head.store(h + 1, std::memory_order_release);
+        }
+
+        uint32_t id; // Chrome trace thread id
+        std::vector<ProfileEvent> events;
+        std::atomic<uint64_t> head{0}; // written by the owner
+        std::atomic<uint64_t> tail{0}; // written by the drainer
+        std::atomic<bool> retired{false};
+    };
+
+    // Thread-local; hands the ring back for reuse when its thread exits
+    struct RingHandle
+    {
+        Ring *ring = nullptr;
+        ~RingHandle()
+        {
+            if (ring)
+                ring->retired.store(true, std::memory_order_release);
+        }
+    };
+
+    struct TraceEvent
+    {
+        ProfileEvent event;
+        uint32_t thread;
+    };
+
+    struct Phase
+    {
+        std::vector<float> ms = std::vector<float>(WINDOW, 0.0f);
+        std::vector<uint16_t> calls = std::vector<uint16_t>(WINDOW, 0);
+    };
+
+    static inline std::atomic<bool> active{false};
+    static constexpr uint32_t GPU_TRACK = 0xFFFF; // trace thread id of GPU events
+    static constexpr const char *GPU_PREFIX = "gpu ";
+    static constexpr double GPU_BOUND_SHARE = 0.9;
+    static const int LABEL_WIDTH = 28;
+
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    std::thread::id mainThreadId = std::this_thread::get_id(); // instance() is first called from main
+    uint32_t mainThread = UINT32_MAX;
+
+    std::mutex ringsMutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::vector<TraceEvent> pending; // drained, not yet accounted
+    size_t lostEvents = 0;
+
+    long long frame = 0;
+    uint64_t frameStart = 0;
+    std::map<std::string, Phase> phases;
+    std::vector<float> frameMs = std::vector<float>(WINDOW, 0.0f);
+    int windowFrames = 0;
+
+    std::string tracePath;
+    bool traceOnly = false; // switch off again after the capture
+    long long traceFirst = 0, traceLast = -1;
+    std::vector<TraceEvent> trace;
+
+    Profiler() {}
+
+    Ring *acquireRing()
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        bool isMain = std::this_thread::get_id() == mainThreadId;
+        for (std::unique_ptr<Ring> &ring : rings)
+        {
+            // a finished thread's ring, once drained, goes to the next new thread
+            if (!isMain && ring->retired.load(std::memory_order_acquire) &&
+                ring->tail.load() == ring->head.load(std::memory_order_acquire))
+            {
+                ring->retired.store(false);
+                return ring.get();
+            }
+        }
+        rings.emplace_back(new Ring((uint32_t)rings.size()));
+        if (isMain)
+            mainThread = rings.back()->id;
+        return rings.back().get();
+    }
+
+    void drainRings()
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        for (std::unique_ptr<Ring> &ring : rings)
+        {
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            uint64_t tail = ring->tail.load();
+            if (head - tail > Ring::CAPACITY)
+            {
+                lostEvents += head - tail - Ring::CAPACITY;
+                tail = head - Ring::CAPACITY;
+            }
+            for (; tail < head; ++tail)
+                pending.push_back({ring->events[tail & (Ring::CAPACITY - 1)], ring->id});
+            ring->tail.store(head);
+        }
+    }
+
+    void accumulate(uint64_t frameNs)
+    {
+        int slot = windowFrames % WINDOW;
+        for (auto &entry : phases)
+        {
+            entry.second.ms[slot] = 0.0f;
+            entry.second.calls[slot] = 0;
+        }
+        for (const TraceEvent &e : pending)
+        {
+            Phase &phase = phases[e.thread == GPU_TRACK ? GPU_PREFIX + std::string(e.event.name) : std::string(e.event.name)];
+            phase.ms[slot] += (e.event.end - e.event.start) / 1.0e6f;
+            phase.calls[slot]++;
+        }
+        frameMs[slot] = frameNs / 1.0e6f;
+        windowFrames++;
+    }
+
+    static bool isGpu(const std::string &name)
+    {
+        return name.compare(0, std::strlen(GPU_PREFIX), GPU_PREFIX) == 0;
+    }
+
+    static PhaseStats summarize(const std::string &name, const std::vector<float> &ms, const std::vector<uint16_t> &calls, int frames)
+    {
+        PhaseStats p{name, 0.0, 0.0, 0.0f};
+        for (int i = 0; i < frames; ++i)
+        {
+            p.meanMs += ms[i];
+            p.maxMs = std::max(p.maxMs, (double)ms[i]);
+            p.callsPerFrame += calls[i];
+        }
+        p.meanMs /= frames;
+        p.callsPerFrame /= frames;
+        return p;
+    }
+
+    bool tracing(long long f) const
+    {
+        return capturing() && f >= traceFirst && (traceLast < 0 || f <= traceLast);
+    }
+
+    void keepForTrace()
+    {
+        trace.insert(trace.end(), pending.begin(), pending.end());
+    }
+
+    void writeTrace()
+    {
+        std::ofstream file(tracePath);
+        if (!file.is_open())
+        {
+            std::cerr << "[ERROR] (PROFILE) could not write " << tracePath << std::endl;
+        }
+        else
+        {
+            file << "{\"traceEvents\":[\n";
+            for (const std::unique_ptr<Ring> &ring : rings)
+            {
+                file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->id << ",\"args\":{\"name\":\""
+                     << (ring->id == mainThread ? "main" : "worker " + std::to_string(ring->id)) << "\"}},\n";
+            }
+            file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << GPU_TRACK << ",\"args\":{\"name\":\"gpu\"}},\n";
+            file << std::fixed << std::setprecision(3);
+            for (size_t i = 0; i < trace.size(); ++i)
+            {
+                const ProfileEvent &e = trace[i].event;
+                file << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << trace[i].thread
+                     << ",\"ts\":" << e.start / 1000.0 << ",\"dur\":" << (e.end - e.start) / 1000.0 << "}"
+                     << (i + 1 < trace.size() ? ",\n" : "\n");
+            }
+            file << "]}\n";
+            std::cout << "[INFO] (PROFILE) " << trace.size() << " events written to " << tracePath << std::endl;
+        }
+        if (lostEvents > 0)
+            std::cout << "[WARN] (PROFILE) " << lostEvents << " events were overwritten before they were read" << std::endl;
+        tracePath.clear();
+        trace.clear();
+        if (traceOnly)
+            setEnabled(false);
+    }
+};
+
+// Times its own lifetime; use through PROFILE_SCOPE
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char *name) : name(Profiler::enabled() ? name : nullptr)
+    {
+        if (this->name)
+            start = Profiler::now();
+    }
+
+    ~ProfileScope() { stop(); }
+
+    // Ends the scope early, for phases that don't fit a block
+    void stop()
+    {
+        if (name)
+            Profiler::instance().record({name, start, Profiler::now()});
+        name = nullptr;
+    }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    const char *name;
+    uint64_t start = 0;
+};
+
+#define PROFILE_JOIN_(a, b) a##b
+#define PROFILE_JOIN(a, b) PROFILE_JOIN_(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_JOIN(profileScope, __LINE__)(name)
+
+#endif
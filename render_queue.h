@@ -0,0 +1,154 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+enum RenderPass
+{
+    PASS_OPAQUE = 0,
+    PASS_EDGES = 1,
+};
+
+// One queued draw: a sort key plus an index back into the caller's object list
+struct DrawItem
+{
+    uint64_t key;
+    uint32_t payload;
+};
+
+// Draws are collected every frame, sorted by key and then submitted in order.
+// Key layout, most significant bits first:
+//   pass (4) | program (10) | depth bucket (20) | geometry (30)
+// Depth sits above geometry because every scene object owns its own VAO, so
+// front-to-back order (early-z) is worth more than grouping equal VAOs.
+class RenderQueue
+{
+public:
+    static const int PASS_BITS = 4;
+    static const int PROGRAM_BITS = 10;
+    static const int DEPTH_BITS = 20;
+    static const int GEOMETRY_BITS = 30;
+
+    // depth is the normalized view distance in [0, 1]
+    static uint64_t makeKey(unsigned int pass, unsigned int program, unsigned int geometry, float depth)
+    {
+        uint64_t depthBucket = (uint64_t)(glm::clamp(depth, 0.0f, 1.0f) * (float)((1u << DEPTH_BITS) - 1));
+
+        uint64_t key = 0;
+        key |= (uint64_t)(pass & ((1u << PASS_BITS) - 1)) << (PROGRAM_BITS + DEPTH_BITS + GEOMETRY_BITS);
+        key |= (uint64_t)(program & ((1u << PROGRAM_BITS) - 1)) << (DEPTH_BITS + GEOMETRY_BITS);
+        key |= depthBucket << GEOMETRY_BITS;
+        key |= (uint64_t)(geometry & ((1u << GEOMETRY_BITS) - 1));
+        return key;
+    }
+
+    static unsigned int keyPass(uint64_t key)
+    {
+        return (unsigned int)(key >> (PROGRAM_BITS + DEPTH_BITS + GEOMETRY_BITS)) & ((1u << PASS_BITS) - 1);
+    }
+
+    static unsigned int keyProgram(uint64_t key)
+    {
+        return (unsigned int)(key >> (DEPTH_BITS + GEOMETRY_BITS)) & ((1u << PROGRAM_BITS) - 1);
+    }
+
+    void clear() { items.clear(); }
+
+    void push(uint64_t key, uint32_t payload) { items.push_back({key, payload}); }
+
+    // LSD radix sort on the key, one byte per pass; passes where every key
+    // shares the same byte are skipped
+    void sort()
+    {
+        size_t n = items.size();
+        if (n < 2)
+            return;
+
+        scratch.resize(n);
+        std::vector<DrawItem> *src = &items;
+        std::vector<DrawItem> *dst = &scratch;
+
+        for (int shift = 0; shift < 64; shift += 8)
+        {
+            size_t counts[256] = {0};
+            for (const DrawItem &item : *src)
+                counts[(item.key >> shift) & 0xFF]++;
+
+            if (counts[((*src)[0].key >> shift) & 0xFF] == n)
+                continue;
+
+            size_t offset = 0;
+            for (int b = 0; b < 256; ++b)
+            {
+                size_t c = counts[b];
+                counts[b] = offset;
+                offset += c;
+            }
+
+            for (const DrawItem &item : *src)
+                (*dst)[counts[(item.key >> shift) & 0xFF]++] = item;
+
+            std::swap(src, dst);
+        }
+
+        if (src != &items)
+            items.swap(scratch);
+    }
+
+    const std::vector<DrawItem> &getItems() const { return items; }
+
+private:
+    std::vector<DrawItem> items;
+    std::vector<DrawItem> scratch;
+};
+
+// Remembers what is bound so sorted submission can skip redundant binds
+struct RenderState
+{
+    GLuint program = 0;
+    GLuint vao = 0;
+    int programBinds = 0;
+    int vaoBinds = 0;
+    int skippedBinds = 0;
+
+    void reset()
+    {
+        program = 0;
+        vao = 0;
+        programBinds = 0;
+        vaoBinds = 0;
+        skippedBinds = 0;
+    }
+
+    // returns true if the program actually changed
+    bool useProgram(GLuint id)
+    {
+        if (id == program)
+        {
+            skippedBinds++;
+            return false;
+        }
+        glUseProgram(id);
+        program = id;
+        programBinds++;
+        return true;
+    }
+
+    void bindVertexArray(GLuint id)
+    {
+        if (id == vao)
+        {
+            skippedBinds++;
+            return;
+        }
+        glBindVertexArray(id);
+        vao = id;
+        vaoBinds++;
+    }
+};
+
+#endif
@@ -0,0 +1,660 @@
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+#include <glad/glad.h>
+#include "text_overlay.h"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+// What the renderer asked of GL in one frame
+struct FrameCounters
+{
+    uint64_t drawCalls = 0;      // draw API calls; a multi-draw counts once
+    uint64_t triangles = 0;      // triangle lists, unindexed strips / fans, and countTriangles()
+    uint64_t vertices = 0;       // submitted, before any tessellation
+    uint64_t patches = 0;        // tessellation patches
+    uint64_t uniformUploads = 0; // glUniform* calls
+    uint64_t bufferUploads = 0;  // glBuffer(Sub)Data with data, and StreamBuffer writes
+    uint64_t bufferBytes = 0;
+    uint64_t stateChanges = 0; // program, VAO, buffer and framebuffer binds, enables, fixed-function state
+};
+
+enum GLObjectType
+{
+    GL_OBJECT_BUFFER,
+    GL_OBJECT_VERTEX_ARRAY,
+    GL_OBJECT_PROGRAM,
+    GL_OBJECT_SHADER,
+    GL_OBJECT_TEXTURE,
+    GL_OBJECT_FRAMEBUFFER,
+    GL_OBJECT_RENDERBUFFER,
+    GL_OBJECT_QUERY,
+    GL_OBJECT_SYNC,
+    GL_OBJECT_TYPE_COUNT
+};
+
+// Per-frame renderer counters and the number of live GL objects of each type.
+// install() swaps glad's function pointers for counting wrappers that forward
+// to the driver, so every call in the process is seen without touching the
+// call sites; only writes into mapped memory have to be reported through
+// countUpload(). A live count that climbs from frame to frame is a leak, and
+// the overlay shows how much each count grew over the last GROWTH_FRAMES.
+//
+// --render-stats FILE writes one CSV row per frame: the frame's counters and
+// the live objects at its end.
+class RenderStats
+{
+public:
+    static const int GROWTH_FRAMES = 60;
+
+    static RenderStats &instance()
+    {
+        static RenderStats stats;
+        return stats;
+    }
+
+    // Right after gladLoadGL, before any GL object is created. Functions the
+    // context doesn't have stay null.
+    void install()
+    {
+        if (installed)
+            return;
+        installed = true;
+        hook(glad_glDrawArrays, real.drawArrays, drawArrays);
+        hook(glad_glDrawElements, real.drawElements, drawElements);
+        hook(glad_glDrawElementsBaseVertex, real.drawElementsBaseVertex, drawElementsBaseVertex);
+        hook(glad_glMultiDrawArrays, real.multiDrawArrays, multiDrawArrays);
+        hook(glad_glMultiDrawElements, real.multiDrawElements, multiDrawElements);
+
+        hook(glad_glUniform1i, real.uniform1i, uniform1i);
+        hook(glad_glUniform1f, real.uniform1f, uniform1f);
+        hook(glad_glUniform2f, real.uniform2f, uniform2f);
+        hook(glad_glUniform3f, real.uniform3f, uniform3f);
+        hook(glad_glUniform4f, real.uniform4f, uniform4f);
+        hook(glad_glUniform2fv, real.uniform2fv, uniform2fv);
+        hook(glad_glUniform3fv, real.uniform3fv, uniform3fv);
+        hook(glad_glUniform4fv, real.uniform4fv, uniform4fv);
+        hook(glad_glUniformMatrix2fv, real.uniformMatrix2fv, uniformMatrix2fv);
+        hook(glad_glUniformMatrix3fv, real.uniformMatrix3fv, uniformMatrix3fv);
+        hook(glad_glUniformMatrix4fv, real.uniformMatrix4fv, uniformMatrix4fv);
+
+        hook(glad_glBufferData, real.bufferData, bufferData);
+        hook(glad_glBufferSubData, real.bufferSubData, bufferSubData);
+        hook(glad_glBufferStorage, real.bufferStorage, bufferStorage);
+
+        hook(glad_glUseProgram, real.useProgram, useProgram);
+        hook(glad_glBindVertexArray, real.bindVertexArray, bindVertexArray);
+        hook(glad_glBindBuffer, real.bindBuffer, bindBuffer);
+        hook(glad_glBindFramebuffer, real.bindFramebuffer, bindFramebuffer);
+        hook(glad_glBindRenderbuffer, real.bindRenderbuffer, bindRenderbuffer);
+        hook(glad_glEnable, real.enable, enable);
+        hook(glad_glDisable, real.disable, disable);
+        hook(glad_glLineWidth, real.lineWidth, lineWidth);
+        hook(glad_glPatchParameteri, real.patchParameteri, patchParameteri);
+        hook(glad_glPrimitiveRestartIndex, real.primitiveRestartIndex, primitiveRestartIndex);
+
+        hook(glad_glGenBuffers, real.genBuffers, genBuffers);
+        hook(glad_glDeleteBuffers, real.deleteBuffers, deleteBuffers);
+        hook(glad_glGenVertexArrays, real.genVertexArrays, genVertexArrays);
+        hook(glad_glDeleteVertexArrays, real.deleteVertexArrays, deleteVertexArrays);
+        hook(glad_glCreateProgram, real.createProgram, createProgram);
+        hook(glad_glDeleteProgram, real.deleteProgram, deleteProgram);
+        hook(glad_glCreateShader, real.createShader, createShader);
+        hook(glad_glDeleteShader, real.deleteShader, deleteShader);
+        hook(glad_glGenTextures, real.genTextures, genTextures);
+        hook(glad_glDeleteTextures, real.deleteTextures, deleteTextures);
+        hook(glad_glGenFramebuffers, real.genFramebuffers, genFramebuffers);
+        hook(glad_glDeleteFramebuffers, real.deleteFramebuffers, deleteFramebuffers);
+        hook(glad_glGenRenderbuffers, real.genRenderbuffers, genRenderbuffers);
+        hook(glad_glDeleteRenderbuffers, real.deleteRenderbuffers, deleteRenderbuffers);
+        hook(glad_glGenQueries, real.genQueries, genQueries);
+        hook(glad_glDeleteQueries, real.deleteQueries, deleteQueries);
+        hook(glad_glFenceSync, real.fenceSync, fenceSync);
+        hook(glad_glDeleteSync, real.deleteSync, deleteSync);
+    }
+
+    // Writes one row per frame from now on
+    bool openDump(const std::string &path)
+    {
+        dump.open(path);
+        if (!dump)
+        {
+            std::cerr << "[ERROR] (RENDER) could not write " << path << std::endl;
+            return false;
+        }
+        dumpPath = path;
+        dump << "frame,draw_calls,triangles,vertices,patches,uniform_uploads,buffer_uploads,buffer_bytes,state_changes";
+        for (const char *name : OBJECT_NAMES)
+            dump << ",live_" << name;
+        dump << "\n";
+        return true;
+    }
+
+    // Triangles of an indexed strip draw, whose restarts the wrappers can't count
+    void countTriangles(uint64_t triangles)
+    {
+        if (counting)
+            current.triangles += triangles;
+    }
+
+    // For writes the wrappers can't see, such as memcpy into a mapped buffer
+    void countUpload(size_t bytes)
+    {
+        if (!counting)
+            return;
+        current.bufferUploads++;
+        current.bufferBytes += bytes;
+    }
+
+    // Call once per frame after its last draw: the counters start over
+    void endFrame()
+    {
+        last = current;
+        current = FrameCounters();
+        if (frame % GROWTH_FRAMES == 0)
+        {
+            for (int t = 0; t < GL_OBJECT_TYPE_COUNT; ++t)
+            {
+                growth[t] = frame > 0 ? live[t] - mark[t] : 0; // not the startup objects
+                mark[t] = live[t];
+            }
+        }
+        if (dump.is_open())
+        {
+            dump << frame << "," << last.drawCalls << "," << last.triangles << "," << last.vertices << "," << last.patches << ","
+                 << last.uniformUploads << "," << last.bufferUploads << "," << last.bufferBytes << "," << last.stateChanges;
+            for (int t = 0; t < GL_OBJECT_TYPE_COUNT; ++t)
+                dump << "," << live[t];
+            dump << "\n";
+        }
+        frame++;
+    }
+
+    void finish()
+    {
+        if (!dump.is_open())
+            return;
+        dump.close();
+        std::cout << "[INFO] (RENDER) wrote " << frame << " frames of renderer stats to " << dumpPath << std::endl;
+    }
+
+    const FrameCounters &lastFrame() const { return last; }
+    int64_t liveObjects(GLObjectType type) const { return live[type]; }
+
+    // The last frame's counters as text; its own draws are not counted
+    void drawOverlay(TextOverlay &overlay)
+    {
+        char line[160];
+        std::vector<std::string> lines;
+        std::snprintf(line, sizeof(line), "FRAME %lld", (long long)frame - 1);
+        lines.push_back(line);
+        std::snprintf(line, sizeof(line), "DRAWS %s  TRIS %s  VERTS %s  PATCHES %s", compact(last.drawCalls).c_str(),
+                      compact(last.triangles).c_str(), compact(last.vertices).c_str(), compact(last.patches).c_str());
+        lines.push_back(line);
+        std::snprintf(line, sizeof(line), "UNIFORMS %s  UPLOADS %s (%s)  STATE %s", compact(last.uniformUploads).c_str(),
+                      compact(last.bufferUploads).c_str(), bytes(last.bufferBytes).c_str(), compact(last.stateChanges).c_str());
+        lines.push_back(line);
+        std::snprintf(line, sizeof(line), "LIVE OBJECTS (GROWTH OVER %d FRAMES)", GROWTH_FRAMES);
+        lines.push_back(line);
+        for (int t = 0; t < GL_OBJECT_TYPE_COUNT; ++t)
+        {
+            std::snprintf(line, sizeof(line), "  %-13s %6lld", OBJECT_NAMES[t], (long long)live[t]);
+            std::string text = line;
+            if (growth[t] != 0)
+                text += (growth[t] > 0 ? " +" : " ") + std::to_string(growth[t]);
+            lines.push_back(text);
+        }
+
+        counting = false;
+        overlay.draw(lines);
+        counting = true;
+    }
+
+private:
+    static constexpr const char *OBJECT_NAMES[GL_OBJECT_TYPE_COUNT] = {
+        "buffers", "vertex_arrays", "programs", "shaders", "textures", "framebuffers", "renderbuffers", "queries", "syncs"};
+
+    struct Originals
+    {
+        PFNGLDRAWARRAYSPROC drawArrays;
+        PFNGLDRAWELEMENTSPROC drawElements;
+        PFNGLDRAWELEMENTSBASEVERTEXPROC drawElementsBaseVertex;
+        PFNGLMULTIDRAWARRAYSPROC multiDrawArrays;
+        PFNGLMULTIDRAWELEMENTSPROC multiDrawElements;
+        PFNGLUNIFORM1IPROC uniform1i;
+        PFNGLUNIFORM1FPROC uniform1f;
+        PFNGLUNIFORM2FPROC uniform2f;
+        PFNGLUNIFORM3FPROC uniform3f;
+        PFNGLUNIFORM4FPROC uniform4f;
+        PFNGLUNIFORM2FVPROC uniform2fv;
+        PFNGLUNIFORM3FVPROC uniform3fv;
+        PFNGLUNIFORM4FVPROC uniform4fv;
+        PFNGLUNIFORMMATRIX2FVPROC uniformMatrix2fv;
+        PFNGLUNIFORMMATRIX3FVPROC uniformMatrix3fv;
+        PFNGLUNIFORMMATRIX4FVPROC uniformMatrix4fv;
+        PFNGLBUFFERDATAPROC bufferData;
+        PFNGLBUFFERSUBDATAPROC bufferSubData;
+        PFNGLBUFFERSTORAGEPROC bufferStorage;
+        PFNGLUSEPROGRAMPROC useProgram;
+        PFNGLBINDVERTEXARRAYPROC bindVertexArray;
+        PFNGLBINDBUFFERPROC bindBuffer;
+        PFNGLBINDFRAMEBUFFERPROC bindFramebuffer;
+        PFNGLBINDRENDERBUFFERPROC bindRenderbuffer;
+        PFNGLENABLEPROC enable;
+        PFNGLDISABLEPROC disable;
+        PFNGLLINEWIDTHPROC lineWidth;
+        PFNGLPATCHPARAMETERIPROC patchParameteri;
+        PFNGLPRIMITIVERESTARTINDEXPROC primitiveRestartIndex;
+        PFNGLGENBUFFERSPROC genBuffers;
+        PFNGLDELETEBUFFERSPROC deleteBuffers;
+        PFNGLGENVERTEXARRAYSPROC genVertexArrays;
+        PFNGLDELETEVERTEXARRAYSPROC deleteVertexArrays;
+        PFNGLCREATEPROGRAMPROC createProgram;
+        PFNGLDELETEPROGRAMPROC deleteProgram;
+        PFNGLCREATESHADERPROC createShader;
+        PFNGLDELETESHADERPROC deleteShader;
+        PFNGLGENTEXTURESPROC genTextures;
+        PFNGLDELETETEXTURESPROC deleteTextures;
+        PFNGLGENFRAMEBUFFERSPROC genFramebuffers;
+        PFNGLDELETEFRAMEBUFFERSPROC deleteFramebuffers;
+        PFNGLGENRENDERBUFFERSPROC genRenderbuffers;
+        PFNGLDELETERENDERBUFFERSPROC deleteRenderbuffers;
+        PFNGLGENQUERIESPROC genQueries;
+        PFNGLDELETEQUERIESPROC deleteQueries;
+        PFNGLFENCESYNCPROC fenceSync;
+        PFNGLDELETESYNCPROC deleteSync;
+    };
+
+    static inline Originals real = {};
+
+    bool installed = false;
+    bool counting = true;
+    FrameCounters current, last;
+    int64_t live[GL_OBJECT_TYPE_COUNT] = {};
+    int64_t mark[GL_OBJECT_TYPE_COUNT] = {};   // live counts GROWTH_FRAMES ago
+    int64_t growth[GL_OBJECT_TYPE_COUNT] = {}; // change over the last GROWTH_FRAMES
+    long long frame = 0;
+    GLint patchVertices = 3;
+    std::ofstream dump;
+    std::string dumpPath;
+
+    RenderStats() {}
+
+    template <typename F>
+    static void hook(F &slot, F &original, F wrapper)
+    {
+        if (!slot)
+            return;
+        original = slot;
+        slot = wrapper;
+    }
+
+    static std::string compact(uint64_t value)
+    {
+        char text[32];
+        if (value < 10000)
+            std::snprintf(text, sizeof(text), "%llu", (unsigned long long)value);
+        else if (value < 10000000)
+            std::snprintf(text, sizeof(text), "%.1fK", value / 1e3);
+        else
+            std::snprintf(text, sizeof(text), "%.1fM", value / 1e6);
+        return text;
+    }
+
+    static std::string bytes(uint64_t value)
+    {
+        char text[32];
+        if (value < 1024 * 1024)
+            std::snprintf(text, sizeof(text), "%.1f KB", value / 1024.0);
+        else
+            std::snprintf(text, sizeof(text), "%.1f MB", value / (1024.0 * 1024.0));
+        return text;
+    }
+
+    // Indexed strips and fans may hold primitive restarts, so their triangles
+    // can't be told from the index count; the caller reports them
+    void countDraw(GLenum mode, uint64_t count, bool indexed)
+    {
+        if (!counting)
+            return;
+        current.vertices += count;
+        if (mode == GL_TRIANGLES)
+            current.triangles += count / 3;
+        else if ((mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN) && count > 2 && !indexed)
+            current.triangles += count - 2;
+        else if (mode == GL_PATCHES && patchVertices > 0)
+            current.patches += count / patchVertices;
+    }
+
+    void countCall(uint64_t FrameCounters::*counter)
+    {
+        if (counting)
+            current.*counter += 1;
+    }
+
+    void countBuffer(const void *data, GLsizeiptr size)
+    {
+        if (data && size > 0)
+            countUpload((size_t)size);
+    }
+
+    void created(GLObjectType type, GLsizei n, const GLuint *names)
+    {
+        for (GLsizei i = 0; i < n; ++i)
+            live[type] += names[i] != 0;
+    }
+
+    void deleted(GLObjectType type, GLsizei n, const GLuint *names)
+    {
+        for (GLsizei i = 0; i < n; ++i)
+            live[type] -= names[i] != 0; // deleting name 0 is a no-op
+    }
+
+    // Draws
+    static void APIENTRY drawArrays(GLenum mode, GLint first, GLsizei count)
+    {
+        instance().countCall(&FrameCounters::drawCalls);
+        instance().countDraw(mode, count, false);
+        real.drawArrays(mode, first, count);
+    }
+
+    static void APIENTRY drawElements(GLenum mode, GLsizei count, GLenum type, const void *indices)
+    {
+        instance().countCall(&FrameCounters::drawCalls);
+        instance().countDraw(mode, count, true);
+        real.drawElements(mode, count, type, indices);
+    }
+
+    static void APIENTRY drawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void *indices, GLint basevertex)
+    {
+        instance().countCall(&FrameCounters::drawCalls);
+        instance().countDraw(mode, count, true);
+        real.drawElementsBaseVertex(mode, count, type, indices, basevertex);
+    }
+
+    static void APIENTRY multiDrawArrays(GLenum mode, const GLint *first, const GLsizei *count, GLsizei drawcount)
+    {
+        instance().countCall(&FrameCounters::drawCalls);
+        for (GLsizei i = 0; i < drawcount; ++i)
+            instance().countDraw(mode, count[i], false);
+        real.multiDrawArrays(mode, first, count, drawcount);
+    }
+
+    static void APIENTRY multiDrawElements(GLenum mode, const GLsizei *count, GLenum type, const void *const *indices, GLsizei drawcount)
+    {
+        instance().countCall(&FrameCounters::drawCalls);
+        for (GLsizei i = 0; i < drawcount; ++i)
+            instance().countDraw(mode, count[i], true);
+        real.multiDrawElements(mode, count, type, indices, drawcount);
+    }
+
+    // Uniforms
+    static void APIENTRY uniform1i(GLint location, GLint v0)
+    {
+        instance().countCall(&FrameCounters::uniformUploads);
+        real.uniform1i(location, v0);
+    }
+
+    static void APIENTRY uniform1f(GLint location, GLfloat v0)
+    {
+        instance().countCall(&FrameCounters::uniformUploads);
+        real.uniform1f(location, v0);
+    }
+
+    static void APIENTRY uniform2f(GLint location, GLfloat v0, GLfloat v1)
+    {
+        instance().countCall(&FrameCounters::uniformUploads);
+        real.uniform2f(location, v0, v1);
+    }
+
+    static void APIENTRY uniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+    {
+        instance().countCall(&FrameCounters::uniformUploads);
+        real.uniform3f(location, v0, v1, v2);
+    }
+
+    static void APIENTRY uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+    {
+        instance().countCall(&FrameCounters::uniformUploads);
+        real.uniform4f(location, v0, v1, v2, v3);
+    }
+
+    static void APIENTRY uniform2fv(GLint location, GLsizei count, const GLfloat *value)
+    {
+        instance().countCall(&FrameCounters::uniformUploads);
+        real.uniform2fv(location, count, value);
+    }
+
+    static void APIENTRY uniform3fv(GLint location, GLsizei count, const GLfloat *value)
+    {
+        instance().countCall(&FrameCounters::uniformUploads);
+        real.uniform3fv(location, count, value);
+    }
+
+    static void APIENTRY uniform4fv(GLint location, GLsizei count, const GLfloat *value)
+    {
+        instance().countCall(&FrameCounters::uniformUploads);
+        real.uniform4fv(location, count, value);
+    }
+
+    static void APIENTRY uniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+    {
+        instance().countCall(&FrameCounters::uniformUploads);
+        real.uniformMatrix2fv(location, count, transpose, value);
+    }
+
+    static void APIENTRY uniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+    {
+        instance().countCall(&FrameCounters::uniformUploads);
+        real.uniformMatrix3fv(location, count, transpose, value);
+    }
+
+    static void APIENTRY uniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+    {
+        instance().countCall(&FrameCounters::uniformUploads);
+        real.uniformMatrix4fv(location, count, transpose, value);
+    }
+
+    // Buffer uploads; allocating without data is not an upload
+    static void APIENTRY bufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+    {
+        instance().countBuffer(data, size);
+        real.bufferData(target, size, data, usage);
+    }
+
+    static void APIENTRY bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
+    {
+        instance().countBuffer(data, size);
+        real.bufferSubData(target, offset, size, data);
+    }
+
+    static void APIENTRY bufferStorage(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags)
+    {
+        instance().countBuffer(data, size);
+        real.bufferStorage(target, size, data, flags);
+    }
+
+    // State changes
+    static void APIENTRY useProgram(GLuint program)
+    {
+        instance().countCall(&FrameCounters::stateChanges);
+        real.useProgram(program);
+    }
+
+    static void APIENTRY bindVertexArray(GLuint array)
+    {
+        instance().countCall(&FrameCounters::stateChanges);
+        real.bindVertexArray(array);
+    }
+
+    static void APIENTRY bindBuffer(GLenum target, GLuint buffer)
+    {
+        instance().countCall(&FrameCounters::stateChanges);
+        real.bindBuffer(target, buffer);
+    }
+
+    static void APIENTRY bindFramebuffer(GLenum target, GLuint framebuffer)
+    {
+        instance().countCall(&FrameCounters::stateChanges);
+        real.bindFramebuffer(target, framebuffer);
+    }
+
+    static void APIENTRY bindRenderbuffer(GLenum target, GLuint renderbuffer)
+    {
+        instance().countCall(&FrameCounters::stateChanges);
+        real.bindRenderbuffer(target, renderbuffer);
+    }
+
+    static void APIENTRY enable(GLenum cap)
+    {
+        instance().countCall(&FrameCounters::stateChanges);
+        real.enable(cap);
+    }
+
+    static void APIENTRY disable(GLenum cap)
+    {
+        instance().countCall(&FrameCounters::stateChanges);
+        real.disable(cap);
+    }
+
+    static void APIENTRY lineWidth(GLfloat width)
+    {
+        instance().countCall(&FrameCounters::stateChanges);
+        real.lineWidth(width);
+    }
+
+    static void APIENTRY patchParameteri(GLenum pname, GLint value)
+    {
+        instance().countCall(&FrameCounters::stateChanges);
+        if (pname == GL_PATCH_VERTICES)
+            instance().patchVertices = value;
+        real.patchParameteri(pname, value);
+    }
+
+    static void APIENTRY primitiveRestartIndex(GLuint index)
+    {
+        instance().countCall(&FrameCounters::stateChanges);
+        real.primitiveRestartIndex(index);
+    }
+
+    // Object lifetimes
+    static void APIENTRY genBuffers(GLsizei n, GLuint *buffers)
+    {
+        real.genBuffers(n, buffers);
+        instance().created(GL_OBJECT_BUFFER, n, buffers);
+    }
+
+    static void APIENTRY deleteBuffers(GLsizei n, const GLuint *buffers)
+    {
+        instance().deleted(GL_OBJECT_BUFFER, n, buffers);
+        real.deleteBuffers(n, buffers);
+    }
+
+    static void APIENTRY genVertexArrays(GLsizei n, GLuint *arrays)
+    {
+        real.genVertexArrays(n, arrays);
+        instance().created(GL_OBJECT_VERTEX_ARRAY, n, arrays);
+    }
+
+    static void APIENTRY deleteVertexArrays(GLsizei n, const GLuint *arrays)
+    {
+        instance().deleted(GL_OBJECT_VERTEX_ARRAY, n, arrays);
+        real.deleteVertexArrays(n, arrays);
+    }
+
+    static GLuint APIENTRY createProgram()
+    {
+        GLuint program = real.createProgram();
+        instance().created(GL_OBJECT_PROGRAM, 1, &program);
+        return program;
+    }
+
+    static void APIENTRY deleteProgram(GLuint program)
+    {
+        instance().deleted(GL_OBJECT_PROGRAM, 1, &program);
+        real.deleteProgram(program);
+    }
+
+    static GLuint APIENTRY createShader(GLenum type)
+    {
+        GLuint shader = real.createShader(type);
+        instance().created(GL_OBJECT_SHADER, 1, &shader);
+        return shader;
+    }
+
+    static void APIENTRY deleteShader(GLuint shader)
+    {
+        instance().deleted(GL_OBJECT_SHADER, 1, &shader);
+        real.deleteShader(shader);
+    }
+
+    static void APIENTRY genTextures(GLsizei n, GLuint *textures)
+    {
+        real.genTextures(n, textures);
+        instance().created(GL_OBJECT_TEXTURE, n, textures);
+    }
+
+    static void APIENTRY deleteTextures(GLsizei n, const GLuint *textures)
+    {
+        instance().deleted(GL_OBJECT_TEXTURE, n, textures);
+        real.deleteTextures(n, textures);
+    }
+
+    static void APIENTRY genFramebuffers(GLsizei n, GLuint *framebuffers)
+    {
+        real.genFramebuffers(n, framebuffers);
+        instance().created(GL_OBJECT_FRAMEBUFFER, n, framebuffers);
+    }
+
+    static void APIENTRY deleteFramebuffers(GLsizei n, const GLuint *framebuffers)
+    {
+        instance().deleted(GL_OBJECT_FRAMEBUFFER, n, framebuffers);
+        real.deleteFramebuffers(n, framebuffers);
+    }
+
+    static void APIENTRY genRenderbuffers(GLsizei n, GLuint *renderbuffers)
+    {
+        real.genRenderbuffers(n, renderbuffers);
+        instance().created(GL_OBJECT_RENDERBUFFER, n, renderbuffers);
+    }
+
+    static void APIENTRY deleteRenderbuffers(GLsizei n, const GLuint *renderbuffers)
+    {
+        instance().deleted(GL_OBJECT_RENDERBUFFER, n, renderbuffers);
+        real.deleteRenderbuffers(n, renderbuffers);
+    }
+
+    static void APIENTRY genQueries(GLsizei n, GLuint *ids)
+    {
+        real.genQueries(n, ids);
+        instance().created(GL_OBJECT_QUERY, n, ids);
+    }
+
+    static void APIENTRY deleteQueries(GLsizei n, const GLuint *ids)
+    {
+        instance().deleted(GL_OBJECT_QUERY, n, ids);
+        real.deleteQueries(n, ids);
+    }
+
+    static GLsync APIENTRY fenceSync(GLenum condition, GLbitfield flags)
+    {
+        GLsync sync = real.fenceSync(condition, flags);
+        if (sync)
+            instance().live[GL_OBJECT_SYNC]++;
+        return sync;
+    }
+
+    static void APIENTRY deleteSync(GLsync sync)
+    {
+        if (sync)
+            instance().live[GL_OBJECT_SYNC]--;
+        real.deleteSync(sync);
+    }
+};
+
+#endif
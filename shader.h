@@ -5,68 +5,55 @@
 #include <glm/glm.hpp>
 
 #include <string>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
+// Tessellation stages (GL 4.0). Both paths may name the same file: each stage
+// also gets TESS_CONTROL or TESS_EVALUATION defined.
+struct ShaderTessellation
+{
+    const char *controlPath;
+    const char *evaluationPath;
+};
+
 class Shader
 {
 public:
     unsigned int id;
 
-    Shader(const char *vertexPath, const char *fragmentPath)
+    // geometryPath is optional; defines are injected after the #version line of
+    // every stage so one source file can be built into several variants
+    Shader(const char *vertexPath, const char *fragmentPath, const char *geometryPath = nullptr, const std::string &defines = "")
     {
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-
-        try
-        {
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-
-            std::stringstream vShaderStream, fShaderStream;
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-
-            vShaderFile.close();
-            fShaderFile.close();
-
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        }
-        catch (std::ifstream::failure &e)
-        {
-            std::cerr << "[ERROR] (SHADER) Failed to read file: " << e.what() << std::endl;
-        }
-
-        const char *vShaderCode = vertexCode.c_str();
-        const char *fShaderCode = fragmentCode.c_str();
-
-        unsigned int vertex, fragment;
-
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
+        std::vector<unsigned int> stages;
+        stages.push_back(compileStage(GL_VERTEX_SHADER, injectDefines(readFile(vertexPath), defines), "VERTEX"));
+        stages.push_back(compileStage(GL_FRAGMENT_SHADER, injectDefines(readFile(fragmentPath), defines), "FRAGMENT"));
+        if (geometryPath)
+            stages.push_back(compileStage(GL_GEOMETRY_SHADER, injectDefines(readFile(geometryPath), defines), "GEOMETRY"));
+        link(stages);
+    }
 
-        id = glCreateProgram();
-        glAttachShader(id, vertex);
-        glAttachShader(id, fragment);
-        glLinkProgram(id);
-        checkCompileErrors(id, "PROGRAM");
+    Shader(const char *vertexPath, const char *fragmentPath, const ShaderTessellation &tessellation, const std::string &defines = "")
+    {
+        std::vector<unsigned int> stages;
+        stages.push_back(compileStage(GL_VERTEX_SHADER, injectDefines(readFile(vertexPath), defines), "VERTEX"));
+        stages.push_back(compileStage(GL_TESS_CONTROL_SHADER, injectDefines(readFile(tessellation.controlPath), defines + "\n#define TESS_CONTROL"), "TESS_CONTROL"));
+        stages.push_back(compileStage(GL_TESS_EVALUATION_SHADER, injectDefines(readFile(tessellation.evaluationPath), defines + "\n#define TESS_EVALUATION"), "TESS_EVALUATION"));
+        stages.push_back(compileStage(GL_FRAGMENT_SHADER, injectDefines(readFile(fragmentPath), defines), "FRAGMENT"));
+        link(stages);
+    }
 
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+    // For small shaders kept as strings next to the code that uses them
+    static Shader fromSource(const char *vertexCode, const char *fragmentCode)
+    {
+        Shader shader;
+        std::vector<unsigned int> stages;
+        stages.push_back(shader.compileStage(GL_VERTEX_SHADER, vertexCode, "VERTEX"));
+        stages.push_back(shader.compileStage(GL_FRAGMENT_SHADER, fragmentCode, "FRAGMENT"));
+        shader.link(stages);
+        return shader;
     }
 
     void use() const
@@ -135,6 +122,60 @@ public:
     }
 
 private:
+    Shader() : id(0) {}
+
+    void link(const std::vector<unsigned int> &stages)
+    {
+        id = glCreateProgram();
+        for (unsigned int stage : stages)
+            glAttachShader(id, stage);
+        glLinkProgram(id);
+        checkCompileErrors(id, "PROGRAM");
+        for (unsigned int stage : stages)
+            glDeleteShader(stage);
+    }
+
+    std::string readFile(const char *path)
+    {
+        std::ifstream file;
+        file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+
+        try
+        {
+            file.open(path);
+            std::stringstream stream;
+            stream << file.rdbuf();
+            file.close();
+            return stream.str();
+        }
+        catch (std::ifstream::failure &e)
+        {
+            std::cerr << "[ERROR] (SHADER) Failed to read file: " << path << " " << e.what() << std::endl;
+        }
+        return "";
+    }
+
+    std::string injectDefines(const std::string &code, const std::string &defines)
+    {
+        if (defines.empty())
+            return code;
+
+        size_t lineEnd = code.find('\n');
+        if (code.rfind("#version", 0) != 0 || lineEnd == std::string::npos)
+            return defines + "\n" + code;
+        return code.substr(0, lineEnd + 1) + defines + "\n" + code.substr(lineEnd + 1);
+    }
+
+    unsigned int compileStage(GLenum type, const std::string &code, const std::string &name)
+    {
+        const char *source = code.c_str();
+        unsigned int shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+        checkCompileErrors(shader, name);
+        return shader;
+    }
+
     void checkCompileErrors(GLuint shader, std::string type)
     {
         GLint success;
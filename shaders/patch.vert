@@ -0,0 +1,8 @@
+#version 400 core
+
+layout (location = 0) in vec2 aPos; // curve control point
+
+void main()
+{
+    gl_Position = vec4(aPos, 0.0, 1.0);
+}
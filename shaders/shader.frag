@@ -15,11 +15,25 @@ uniform float shininess;
 uniform vec3 lightPos;
 uniform vec3 viewPos;
 
-void main()
+#ifdef WIREFRAME
+in vec3 barycentric;
+
+uniform vec3 wireframeColor;
+uniform float wireframeWidth; // in pixels
+
+// 0 on a triangle edge, 1 once we are wireframeWidth pixels inside
+float edgeFactor()
+{
+    vec3 d = fwidth(barycentric);
+    vec3 a = smoothstep(vec3(0.0), d * wireframeWidth, barycentric);
+    return min(min(a.x, a.y), a.z);
+}
+#endif
+
+vec3 shade()
 {
     if (!lightingEnabled) {
-        FragColor = vec4(fs_in.color, 1.0);
-        return;
+        return fs_in.color;
     }
 
     // ambient
@@ -38,5 +52,14 @@ void main()
     float spec = pow(max(dot(normal, halfwayDir), 0.0), shininess);
     vec3 specular = vec3(lightStrength) * spec; 
 
-    FragColor = vec4(ambient + diffuse + specular, 1.0);
+    return ambient + diffuse + specular;
+}
+
+void main()
+{
+    vec3 result = shade();
+#ifdef WIREFRAME
+    result = mix(wireframeColor, result, edgeFactor());
+#endif
+    FragColor = vec4(result, 1.0);
 }
\ No newline at end of file
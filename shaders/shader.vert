@@ -14,10 +14,16 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// packed meshes store unorm16 positions relative to their bounds;
+// float meshes use scale 1 and offset 0
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+
 void main()
 {
-    vs_out.pos = aPos;
+    vec3 pos = aPos * positionScale + positionOffset;
+    vs_out.pos = pos;
     vs_out.normal = aNormal;
     vs_out.color = aColor;
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = projection * view * model * vec4(pos, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,605 @@
+#ifndef SIMPLIFY_H
+#define SIMPLIFY_H
+
+#include <glm/glm.hpp>
+#include "mesh.h"
+#include "mesh_optimizer.h"
+#include "profiler.h"
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <cfloat>
+#include <cmath>
+#include <iostream>
+
+// Symmetric 4x4 error quadric, only the 10 unique coefficients are stored.
+// weight accumulates the plane weights so errors can be read back as distances.
+struct Quadric
+{
+    double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+    double a11 = 0, a12 = 0, a13 = 0;
+    double a22 = 0, a23 = 0;
+    double a33 = 0;
+    double weight = 0;
+
+    // squared distance to the plane n.p + d = 0 (n normalized), scaled by weight
+    static Quadric fromPlane(const glm::vec3 &n, double d, double weight)
+    {
+        Quadric q;
+        q.a00 = weight * n.x * n.x;
+        q.a01 = weight * n.x * n.y;
+        q.a02 = weight * n.x * n.z;
+        q.a03 = weight * n.x * d;
+        q.a11 = weight * n.y * n.y;
+        q.a12 = weight * n.y * n.z;
+        q.a13 = weight * n.y * d;
+        q.a22 = weight * n.z * n.z;
+        q.a23 = weight * n.z * d;
+        q.a33 = weight * d * d;
+        q.weight = weight;
+        return q;
+    }
+
+    void add(const Quadric &o)
+    {
+        a00 += o.a00, a01 += o.a01, a02 += o.a02, a03 += o.a03;
+        a11 += o.a11, a12 += o.a12, a13 += o.a13;
+        a22 += o.a22, a23 += o.a23;
+        a33 += o.a33;
+        weight += o.weight;
+    }
+
+    // weighted mean squared distance of p to the accumulated planes
+    double evaluate(const glm::vec3 &p) const
+    {
+        double x = p.x, y = p.y, z = p.z;
+        double r = a00 * x * x + a11 * y * y + a22 * z * z + a33;
+        r += 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z);
+        r += 2.0 * (a03 * x + a13 * y + a23 * z);
+        return (weight > 0.0) ? std::max(r, 0.0) / weight : 0.0;
+    }
+};
+
+// How a position may move during simplification
+enum SimplifyVertexKind
+{
+    SIMPLIFY_MANIFOLD, // interior, single set of attributes: collapses anywhere
+    SIMPLIFY_BORDER,   // on an open boundary: only slides along the boundary
+    SIMPLIFY_SEAM,     // on a color/normal seam: only slides along the seam
+    SIMPLIFY_LOCKED,   // seam/border corners and non-manifold spots never move
+};
+
+// Quadric-error edge-collapse simplifier (Garland-Heckbert, half-edge collapses).
+// Vertices that share a position but differ in normal or color form seams; those
+// are collapsed as a unit so seams stay sharp. Returns a new index list into the
+// unchanged vertex array with at most targetIndexCount indices where possible.
+// resultError receives the object-space error estimate of the result.
+std::vector<unsigned int> simplifyMesh(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices,
+                                       size_t targetIndexCount, float targetError = FLT_MAX, float *resultError = nullptr)
+{
+    PROFILE_SCOPE("simplifyMesh");
+    std::vector<unsigned int> result(indices);
+    if (resultError)
+        *resultError = 0.0f;
+    if (indices.size() < 3 || targetIndexCount >= indices.size())
+        return result;
+
+    // weld by exact position so seams share one topological vertex
+    struct PositionHash
+    {
+        size_t operator()(const glm::vec3 &p) const
+        {
+            // + 0 folds -0.0 into 0.0 so equal positions hash equally
+            glm::vec3 q = p + glm::vec3(0.0f);
+            uint32_t w[3];
+            std::memcpy(w, &q, sizeof(w));
+            return (w[0] * 73856093u) ^ (w[1] * 19349663u) ^ (w[2] * 83492791u);
+        }
+    };
+    std::unordered_map<glm::vec3, unsigned int, PositionHash> positionIds;
+    std::vector<unsigned int> positionOf(vertices.size());
+    std::vector<glm::vec3> positions;
+    for (size_t v = 0; v < vertices.size(); ++v)
+    {
+        auto it = positionIds.emplace(vertices[v].position, (unsigned int)positions.size());
+        if (it.second)
+            positions.push_back(vertices[v].position);
+        positionOf[v] = it.first->second;
+    }
+    size_t positionCount = positions.size();
+
+    auto edgeKey = [](unsigned int a, unsigned int b)
+    {
+        return (a < b) ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+    };
+
+    struct EdgeInfo
+    {
+        int triangles = 0;
+        unsigned int wedgeLo = 0, wedgeHi = 0; // wedges at the lower / higher position id
+        bool seam = false;
+    };
+    std::unordered_map<uint64_t, EdgeInfo> edges;
+
+    auto gatherEdges = [&]()
+    {
+        edges.clear();
+        edges.reserve(result.size());
+        for (size_t t = 0; t < result.size(); t += 3)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                unsigned int wa = result[t + k], wb = result[t + (k + 1) % 3];
+                unsigned int pa = positionOf[wa], pb = positionOf[wb];
+                if (pa > pb)
+                {
+                    std::swap(pa, pb);
+                    std::swap(wa, wb);
+                }
+                EdgeInfo &e = edges[edgeKey(pa, pb)];
+                if (e.triangles == 0)
+                {
+                    e.wedgeLo = wa;
+                    e.wedgeHi = wb;
+                }
+                else if (e.wedgeLo != wa || e.wedgeHi != wb)
+                    e.seam = true;
+                e.triangles++;
+            }
+        }
+    };
+
+    std::vector<SimplifyVertexKind> kind(positionCount);
+    auto classify = [&]()
+    {
+        std::vector<int> borderEdges(positionCount, 0), seamEdges(positionCount, 0);
+        std::vector<bool> nonManifold(positionCount, false);
+        for (const auto &entry : edges)
+        {
+            unsigned int pa = (unsigned int)(entry.first >> 32), pb = (unsigned int)(entry.first & 0xFFFFFFFFu);
+            const EdgeInfo &e = entry.second;
+            if (e.triangles > 2)
+                nonManifold[pa] = nonManifold[pb] = true;
+            else if (e.triangles == 1)
+                borderEdges[pa]++, borderEdges[pb]++;
+            else if (e.seam)
+                seamEdges[pa]++, seamEdges[pb]++;
+        }
+
+        // distinct wedges per position
+        std::vector<unsigned int> firstWedge(positionCount, RESTART_INDEX);
+        std::vector<bool> multiWedge(positionCount, false);
+        for (unsigned int w : result)
+        {
+            unsigned int p = positionOf[w];
+            if (firstWedge[p] == RESTART_INDEX)
+                firstWedge[p] = w;
+            else if (firstWedge[p] != w)
+                multiWedge[p] = true;
+        }
+
+        for (size_t p = 0; p < positionCount; ++p)
+        {
+            if (nonManifold[p] || (borderEdges[p] && (seamEdges[p] || multiWedge[p])))
+                kind[p] = SIMPLIFY_LOCKED;
+            else if (borderEdges[p])
+                kind[p] = (borderEdges[p] == 2) ? SIMPLIFY_BORDER : SIMPLIFY_LOCKED;
+            else if (seamEdges[p])
+                kind[p] = (seamEdges[p] == 2) ? SIMPLIFY_SEAM : SIMPLIFY_LOCKED;
+            else
+                kind[p] = multiWedge[p] ? SIMPLIFY_LOCKED : SIMPLIFY_MANIFOLD;
+        }
+    };
+
+    // plane quadrics of every triangle, plus perpendicular planes that keep
+    // borders and seams from drifting sideways
+    const double EDGE_WEIGHT = 4.0;
+    std::vector<Quadric> quadrics(positionCount);
+    gatherEdges();
+    for (size_t t = 0; t < result.size(); t += 3)
+    {
+        const glm::vec3 &p0 = positions[positionOf[result[t]]];
+        const glm::vec3 &p1 = positions[positionOf[result[t + 1]]];
+        const glm::vec3 &p2 = positions[positionOf[result[t + 2]]];
+        glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+        float len = glm::length(n);
+        if (len == 0.0f)
+            continue;
+        n /= len;
+
+        // area weighted, so slivers don't outvote the big faces
+        Quadric q = Quadric::fromPlane(n, -glm::dot(n, p0), len * 0.5f);
+        for (int k = 0; k < 3; ++k)
+            quadrics[positionOf[result[t + k]]].add(q);
+
+        const glm::vec3 corners[3] = {p0, p1, p2};
+        for (int k = 0; k < 3; ++k)
+        {
+            unsigned int pa = positionOf[result[t + k]], pb = positionOf[result[t + (k + 1) % 3]];
+            const EdgeInfo &e = edges[edgeKey(pa, pb)];
+            if (e.triangles != 1 && !e.seam)
+                continue;
+
+            glm::vec3 edge = corners[(k + 1) % 3] - corners[k];
+            glm::vec3 side = glm::cross(edge, n);
+            float sideLen = glm::length(side);
+            if (sideLen == 0.0f)
+                continue;
+            side /= sideLen;
+            Quadric c = Quadric::fromPlane(side, -glm::dot(side, corners[k]), EDGE_WEIGHT * glm::dot(edge, edge));
+            quadrics[pa].add(c);
+            quadrics[pb].add(c);
+        }
+    }
+
+    struct Collapse
+    {
+        unsigned int from, to;
+        double cost;
+    };
+    std::vector<Collapse> candidates;
+    std::vector<unsigned int> adjacencyOffsets, adjacency, fill;
+    std::vector<bool> touched(positionCount), removed;
+    std::vector<unsigned int> neighborsFrom, neighborsTo;
+    std::unordered_map<unsigned int, unsigned int> wedgeMap;
+    double maxError = 0.0;
+    bool relaxed = false;
+    double errorLimit = (targetError == FLT_MAX) ? DBL_MAX : (double)targetError * (double)targetError;
+
+    while (result.size() > targetIndexCount)
+    {
+        gatherEdges();
+        classify();
+
+        size_t triangleCount = result.size() / 3;
+
+        // position -> triangles
+        adjacencyOffsets.assign(positionCount + 1, 0);
+        for (unsigned int w : result)
+            adjacencyOffsets[positionOf[w] + 1]++;
+        for (size_t p = 0; p < positionCount; ++p)
+            adjacencyOffsets[p + 1] += adjacencyOffsets[p];
+        adjacency.resize(result.size());
+        fill.assign(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < result.size(); ++i)
+            adjacency[fill[positionOf[result[i]]]++] = (unsigned int)(i / 3);
+
+        candidates.clear();
+        for (const auto &entry : edges)
+        {
+            unsigned int pa = (unsigned int)(entry.first >> 32), pb = (unsigned int)(entry.first & 0xFFFFFFFFu);
+            const EdgeInfo &e = entry.second;
+            const unsigned int ends[2][2] = {{pa, pb}, {pb, pa}};
+            for (const auto &dir : ends)
+            {
+                unsigned int from = dir[0], to = dir[1];
+                SimplifyVertexKind k = kind[from];
+                bool allowed = (k == SIMPLIFY_MANIFOLD) ||
+                               (k == SIMPLIFY_BORDER && e.triangles == 1) ||
+                               (k == SIMPLIFY_SEAM && e.seam && e.triangles == 2);
+                if (!allowed)
+                    continue;
+
+                Quadric q = quadrics[from];
+                q.add(quadrics[to]);
+                candidates.push_back({from, to, q.evaluate(positions[to])});
+            }
+        }
+        if (candidates.empty())
+            break;
+
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const Collapse &a, const Collapse &b)
+                  { return a.cost < b.cost; });
+
+        // about two triangles go per collapse; stop the pass halfway to stay greedy
+        size_t collapseBudget = (triangleCount - targetIndexCount / 3) / 2 + 1;
+        size_t collapsed = 0, trianglesLeft = triangleCount;
+
+        // cap the pass a bit above the budget-th cheapest cost, so cheap collapses
+        // blocked by a neighbor wait for the next pass instead of costly ones going now
+        double passLimit = errorLimit;
+        if (!relaxed)
+            passLimit = std::min(errorLimit, candidates[std::min(collapseBudget, candidates.size() - 1)].cost * 1.5);
+        std::fill(touched.begin(), touched.end(), false);
+        removed.assign(triangleCount, false);
+
+        for (const Collapse &c : candidates)
+        {
+            if (collapsed >= collapseBudget || trianglesLeft * 3 <= targetIndexCount || c.cost > passLimit)
+                break;
+            if (touched[c.from] || touched[c.to])
+                continue;
+
+            // link condition: the two ends may only share the vertices opposite the edge
+            neighborsFrom.clear();
+            neighborsTo.clear();
+            int edgeTriangles = 0;
+            for (unsigned int a = adjacencyOffsets[c.from]; a < adjacencyOffsets[c.from + 1]; ++a)
+                for (int k = 0; k < 3; ++k)
+                    neighborsFrom.push_back(positionOf[result[adjacency[a] * 3 + k]]);
+            for (unsigned int a = adjacencyOffsets[c.to]; a < adjacencyOffsets[c.to + 1]; ++a)
+                for (int k = 0; k < 3; ++k)
+                    neighborsTo.push_back(positionOf[result[adjacency[a] * 3 + k]]);
+            std::sort(neighborsFrom.begin(), neighborsFrom.end());
+            neighborsFrom.erase(std::unique(neighborsFrom.begin(), neighborsFrom.end()), neighborsFrom.end());
+            std::sort(neighborsTo.begin(), neighborsTo.end());
+            neighborsTo.erase(std::unique(neighborsTo.begin(), neighborsTo.end()), neighborsTo.end());
+            size_t shared = 0;
+            for (size_t i = 0, j = 0; i < neighborsFrom.size() && j < neighborsTo.size();)
+            {
+                if (neighborsFrom[i] < neighborsTo[j])
+                    i++;
+                else if (neighborsFrom[i] > neighborsTo[j])
+                    j++;
+                else
+                    shared++, i++, j++;
+            }
+
+            // wedge mapping from the triangles on the edge, and a flip test for the rest
+            wedgeMap.clear();
+            bool valid = true;
+            for (unsigned int a = adjacencyOffsets[c.from]; a < adjacencyOffsets[c.from + 1] && valid; ++a)
+            {
+                const unsigned int *tri = &result[adjacency[a] * 3];
+                int fromCorner = -1, toCorner = -1;
+                for (int k = 0; k < 3; ++k)
+                {
+                    if (positionOf[tri[k]] == c.from)
+                        fromCorner = k;
+                    else if (positionOf[tri[k]] == c.to)
+                        toCorner = k;
+                }
+
+                if (toCorner >= 0)
+                {
+                    edgeTriangles++;
+                    auto it = wedgeMap.emplace(tri[fromCorner], tri[toCorner]);
+                    if (!it.second && it.first->second != tri[toCorner])
+                        valid = false;
+                    continue;
+                }
+
+                const glm::vec3 &p0 = positions[positionOf[tri[0]]];
+                const glm::vec3 &p1 = positions[positionOf[tri[1]]];
+                const glm::vec3 &p2 = positions[positionOf[tri[2]]];
+                glm::vec3 before = glm::cross(p1 - p0, p2 - p0);
+                glm::vec3 moved[3] = {p0, p1, p2};
+                moved[fromCorner] = positions[c.to];
+                glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+                if (glm::dot(before, after) <= 0.0f)
+                    valid = false;
+            }
+            // the two opposite vertices (one on a border) plus both ends themselves
+            if (!valid || edgeTriangles == 0 || shared > (size_t)edgeTriangles + 2)
+                continue;
+
+            for (unsigned int a = adjacencyOffsets[c.from]; a < adjacencyOffsets[c.from + 1] && valid; ++a)
+            {
+                const unsigned int *tri = &result[adjacency[a] * 3];
+                for (int k = 0; k < 3; ++k)
+                    if (positionOf[tri[k]] == c.from && wedgeMap.find(tri[k]) == wedgeMap.end())
+                        valid = false;
+            }
+            if (!valid)
+                continue;
+
+            for (unsigned int a = adjacencyOffsets[c.from]; a < adjacencyOffsets[c.from + 1]; ++a)
+            {
+                unsigned int t = adjacency[a];
+                unsigned int *tri = &result[t * 3];
+                bool hasTo = false;
+                for (int k = 0; k < 3; ++k)
+                    hasTo |= positionOf[tri[k]] == c.to;
+                if (hasTo)
+                {
+                    removed[t] = true;
+                    trianglesLeft--;
+                    continue;
+                }
+                for (int k = 0; k < 3; ++k)
+                    if (positionOf[tri[k]] == c.from)
+                        tri[k] = wedgeMap[tri[k]];
+            }
+
+            // nothing else around this edge moves until the next pass rebuilds adjacency
+            quadrics[c.to].add(quadrics[c.from]);
+            for (unsigned int n : neighborsFrom)
+                touched[n] = true;
+            touched[c.to] = true;
+            maxError = std::max(maxError, c.cost);
+            collapsed++;
+        }
+
+        if (collapsed == 0)
+        {
+            if (relaxed || passLimit >= errorLimit)
+                break;
+            relaxed = true;
+            continue;
+        }
+        relaxed = false;
+
+        size_t write = 0;
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            if (removed[t])
+                continue;
+            for (int k = 0; k < 3; ++k)
+                result[write++] = result[t * 3 + k];
+        }
+        result.resize(write);
+    }
+
+    if (resultError)
+        *resultError = (float)std::sqrt(maxError);
+    return result;
+}
+
+// Progressively coarser versions of a mesh. Levels don't include the source
+// mesh itself; errors are object-space and grow with the level.
+struct LodChain
+{
+    std::vector<Mesh> levels;
+    std::vector<float> errors;
+
+    // coarsest level whose error stays under maxPixelError, -1 for the full mesh
+    int select(float pixelsPerUnit, float maxPixelError) const
+    {
+        for (int i = (int)levels.size() - 1; i >= 0; --i)
+        {
+            if (errors[i] * pixelsPerUnit <= maxPixelError)
+                return i;
+        }
+        return -1;
+    }
+};
+
+// True when every corner carries its face normal (faceted OFF models)
+bool isFlatShaded(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices)
+{
+    for (size_t t = 0; t + 2 < indices.size(); t += 3)
+    {
+        const Vertex &a = vertices[indices[t]], &b = vertices[indices[t + 1]], &c = vertices[indices[t + 2]];
+        glm::vec3 n = glm::cross(b.position - a.position, c.position - a.position);
+        float len = glm::length(n);
+        if (len == 0.0f)
+            continue;
+        n /= len;
+        if (std::fabs(glm::dot(n, a.normal)) < 0.999f || std::fabs(glm::dot(n, b.normal)) < 0.999f ||
+            std::fabs(glm::dot(n, c.normal)) < 0.999f)
+            return false;
+    }
+    return true;
+}
+
+// Merges corners that share position and color and whose normals are within
+// creaseAngle degrees, averaging the normals. Faceted meshes would otherwise be
+// all seams; after this only real creases and color borders stay seams.
+void smoothCreases(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices, float creaseAngle)
+{
+    struct CornerKey
+    {
+        glm::vec3 position, color;
+        bool operator==(const CornerKey &o) const { return position == o.position && color == o.color; }
+    };
+    struct CornerHash
+    {
+        size_t operator()(const CornerKey &k) const
+        {
+            uint32_t w[6];
+            glm::vec3 p = k.position + glm::vec3(0.0f), c = k.color + glm::vec3(0.0f);
+            std::memcpy(w, &p, sizeof(p));
+            std::memcpy(w + 3, &c, sizeof(c));
+            size_t h = 2166136261u;
+            for (uint32_t x : w)
+                h = (h ^ x) * 16777619u;
+            return h;
+        }
+    };
+
+    float cosCrease = std::cos(glm::radians(creaseAngle));
+    std::unordered_map<CornerKey, std::vector<unsigned int>, CornerHash> groups; // -> smoothed vertex ids
+    std::vector<Vertex> result;
+    std::vector<glm::vec3> normalSums;
+
+    for (unsigned int &index : indices)
+    {
+        const Vertex &v = vertices[index];
+        std::vector<unsigned int> &group = groups[{v.position, v.color}];
+
+        unsigned int match = RESTART_INDEX;
+        for (unsigned int candidate : group)
+        {
+            if (glm::dot(glm::normalize(normalSums[candidate]), v.normal) >= cosCrease)
+            {
+                match = candidate;
+                break;
+            }
+        }
+        if (match == RESTART_INDEX)
+        {
+            match = (unsigned int)result.size();
+            result.push_back(v);
+            normalSums.push_back(glm::vec3(0.0f));
+            group.push_back(match);
+        }
+        normalSums[match] += v.normal;
+        index = match;
+    }
+
+    for (size_t i = 0; i < result.size(); ++i)
+        result[i].normal = glm::normalize(normalSums[i]);
+    vertices.swap(result);
+}
+
+// Gives every triangle its own corners with the face normal again
+void flattenNormals(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices)
+{
+    std::vector<Vertex> result;
+    result.reserve(indices.size());
+    for (size_t t = 0; t + 2 < indices.size(); t += 3)
+    {
+        Vertex corners[3] = {vertices[indices[t]], vertices[indices[t + 1]], vertices[indices[t + 2]]};
+        glm::vec3 n = glm::cross(corners[1].position - corners[0].position, corners[2].position - corners[0].position);
+        n = (glm::length(n) > 0.0f) ? glm::normalize(n) : corners[0].normal;
+        // keep the source's normal convention, OFF winding doesn't always match it
+        if (glm::dot(n, corners[0].normal + corners[1].normal + corners[2].normal) < 0.0f)
+            n = -n;
+        for (Vertex &corner : corners)
+        {
+            corner.normal = n;
+            result.push_back(corner);
+        }
+    }
+    for (size_t i = 0; i < indices.size(); ++i)
+        indices[i] = (unsigned int)i;
+    vertices.swap(result);
+    deduplicateVertices(vertices, indices);
+}
+
+// Simplifies each level from the previous one down to the given triangle ratios
+// of the source mesh. Stops early once the simplifier can't make progress.
+// Faceted meshes are simplified on smoothed normals and re-faceted per level.
+LodChain buildLodChain(const Mesh &mesh, const std::vector<float> &ratios = {0.5f, 0.25f, 0.1f, 0.03f},
+                       float creaseAngle = 40.0f)
+{
+    PROFILE_SCOPE("buildLodChain");
+    LodChain chain;
+    std::vector<Vertex> base = mesh.vertices;
+    std::vector<unsigned int> current = mesh.indices;
+    bool flat = isFlatShaded(base, current);
+    if (flat)
+        smoothCreases(base, current, creaseAngle);
+
+    float error = 0.0f;
+    for (float ratio : ratios)
+    {
+        size_t target = (size_t)(mesh.indices.size() / 3 * ratio) * 3;
+        float levelError = 0.0f;
+        std::vector<unsigned int> lod = simplifyMesh(base, current, target, FLT_MAX, &levelError);
+        if (lod.size() >= current.size() * 95 / 100)
+            break;
+
+        // each level starts from the previous one, so errors add up
+        error += levelError;
+        current = lod;
+
+        std::vector<Vertex> levelVertices = base;
+        if (flat)
+            flattenNormals(levelVertices, lod);
+        optimizeVertexCache(lod, levelVertices.size());
+        optimizeVertexFetch(levelVertices, lod);
+        chain.levels.emplace_back(levelVertices, lod);
+        chain.errors.push_back(error);
+
+        std::cout << "[INFO] (LOD) level " << chain.levels.size() << ": " << lod.size() / 3 << "/"
+                  << mesh.indices.size() / 3 << " triangles, error " << error << std::endl;
+    }
+
+    return chain;
+}
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <glad/glad.h>
+#include "profiler.h"
+#include "render_stats.h"
+
+#include <cstring>
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+
+// Ring buffer for geometry rewritten every frame. The buffer holds FRAMES
+// regions; a frame only writes into its own region, and endFrame() fences it
+// and waits for the fence of the region it moves on to, so the GPU is never
+// still reading what the CPU overwrites and writes are a plain memcpy.
+// With GL 4.4 the buffer is persistently mapped once. Otherwise the whole
+// buffer is orphaned at the start of each frame and written through
+// unsynchronized map ranges, which leaves the renaming to the driver.
+//
+// write() returns a byte offset into buffer(); draws source from it through
+// the `first` / base vertex / index pointer arguments, so VAOs can point at
+// the buffer once with offset 0.
+//
+// A write that does not fit grows the regions geometrically (at least doubling)
+// into a fresh allocation, so capacity settles after a few frames instead of
+// reallocating every frame. Growing bumps generation(): VAOs have to re-point
+// at buffer(), and offsets returned earlier in the frame are no longer valid.
+class StreamBuffer
+{
+public:
+    static constexpr int FRAMES = 3;
+
+    StreamBuffer() {}
+
+    void create(size_t frameBytes)
+    {
+        persistent = GLAD_GL_VERSION_4_4 && glBufferStorage;
+        allocate(frameBytes);
+        if (persistent && id == 0)
+        {
+            persistent = false;
+            allocate(frameBytes);
+        }
+        std::cout << "[INFO] (STREAM) " << capacity() << " byte ring, "
+                  << (persistent ? "persistent mapping" : "orphaning") << std::endl;
+    }
+
+    void destroy()
+    {
+        release();
+        mapped = nullptr;
+    }
+
+    GLuint buffer() const { return id; }
+    bool isPersistent() const { return persistent; }
+    size_t capacity() const { return regionSize * (persistent ? FRAMES : 1); }
+    unsigned int generation() const { return allocations; }
+
+    // Copies size bytes to an offset that is a multiple of alignment (any
+    // value, so vertex strides work for base vertex / first). Grows the ring
+    // when the frame's region is full; returns false only if mapping failed,
+    // in which case nothing was written and offset is not set.
+    bool write(const void *data, size_t size, size_t alignment, size_t &offset)
+    {
+        size_t begin = ((regionBase() + head + alignment - 1) / alignment) * alignment; // absolute, for first / base vertex
+        if (begin + size > regionBase() + regionSize)
+        {
+            release();
+            allocate(std::max(regionSize * 2, size));
+            std::cout << "[INFO] (STREAM) grown to " << capacity() << " bytes" << std::endl;
+            if (id == 0)
+                return false;
+            begin = 0;
+        }
+
+        if (persistent)
+        {
+            std::memcpy(mapped + begin, data, size);
+        }
+        else if (size > 0)
+        {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+            void *dst = glMapBufferRange(GL_COPY_WRITE_BUFFER, begin, size,
+                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+            if (dst)
+            {
+                std::memcpy(dst, data, size);
+                glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            }
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            if (!dst)
+                return false; // nothing written, the caller must not draw from it
+        }
+
+        RenderStats::instance().countUpload(size); // mapped writes bypass glBufferSubData
+        head = begin + size - regionBase();
+        offset = begin;
+        return true;
+    }
+
+    // Call once per frame after the draws that read this frame's writes
+    void endFrame()
+    {
+        if (id == 0)
+            return;
+        PROFILE_SCOPE("streamEndFrame"); // the fence flushes, a driver may render here
+        bool written = head > 0;
+        head = 0;
+        if (!persistent)
+        {
+            // a fresh allocation for the next frame, the old one lives until the GPU
+            // is done; a frame that wrote nothing left the current one untouched
+            if (written)
+            {
+                glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+                glBufferData(GL_COPY_WRITE_BUFFER, regionSize, nullptr, GL_STREAM_DRAW);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            }
+            return;
+        }
+
+        fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        current = (current + 1) % FRAMES;
+        if (fences[current])
+        {
+            // normally already signalled, FRAMES - 1 frames have passed
+            while (glClientWaitSync(fences[current], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+                ;
+            glDeleteSync(fences[current]);
+            fences[current] = 0;
+        }
+    }
+
+private:
+    GLuint id = 0;
+    size_t regionSize = 0;
+    bool persistent = false;
+    char *mapped = nullptr;
+    int current = 0; // region written this frame
+    size_t head = 0; // bytes used in it
+    GLsync fences[FRAMES] = {};
+    unsigned int allocations = 0;
+
+    size_t regionBase() const { return persistent ? current * regionSize : 0; }
+
+    // A new buffer object: persistent storage is immutable, and a new name keeps
+    // draws already issued this frame reading the old one until the GPU is done
+    void allocate(size_t frameBytes)
+    {
+        regionSize = frameBytes;
+        current = 0;
+        head = 0;
+        allocations++;
+        glGenBuffers(1, &id);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+        if (persistent)
+        {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_COPY_WRITE_BUFFER, regionSize * FRAMES, nullptr, flags);
+            mapped = static_cast<char *>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, regionSize * FRAMES, flags));
+            if (!mapped)
+            {
+                glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+                glDeleteBuffers(1, &id);
+                id = 0;
+                std::cerr << "[ERROR] (STREAM) could not map " << regionSize * FRAMES << " bytes" << std::endl;
+                return;
+            }
+        }
+        else
+        {
+            glBufferData(GL_COPY_WRITE_BUFFER, regionSize, nullptr, GL_STREAM_DRAW);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    // fences only guard regions of this buffer, so they can go with it
+    void release()
+    {
+        for (GLsync &fence : fences)
+        {
+            if (fence)
+                glDeleteSync(fence);
+            fence = 0;
+        }
+        if (id == 0)
+            return;
+        if (persistent && mapped)
+        {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &id);
+        id = 0;
+    }
+};
+
+#endif
@@ -0,0 +1,497 @@
+#ifndef SUBDIVISION_H
+#define SUBDIVISION_H
+
+#include <glm/glm.hpp>
+#include "mesh.h"
+#include "halfedge.h"
+#include "profiler.h"
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <thread>
+#include <cstdint>
+#include <iostream>
+
+enum SubdivisionScheme
+{
+    SUBDIVIDE_LOOP,         // triangles, approximating C2 box spline
+    SUBDIVIDE_CATMULL_CLARK, // quad-dominant input, triangle pairs are merged back into quads
+};
+
+// Sparse matrix in CSR form: row i of the refined level is
+// sum(weights[k] * in[sources[k]]) for k in [offsets[i], offsets[i + 1]).
+struct StencilTable
+{
+    std::vector<unsigned int> offsets{0};
+    std::vector<unsigned int> sources;
+    std::vector<float> weights;
+
+    size_t size() const { return offsets.size() - 1; }
+
+    // rows are independent, so large tables are split across hardware threads
+    template <typename T>
+    void apply(const std::vector<T> &in, std::vector<T> &out) const
+    {
+        out.resize(size());
+        auto rows = [&](size_t begin, size_t end)
+        {
+            PROFILE_SCOPE("stencilRows");
+            for (size_t i = begin; i < end; ++i)
+            {
+                T sum(0.0f);
+                for (unsigned int k = offsets[i]; k < offsets[i + 1]; ++k)
+                    sum += weights[k] * in[sources[k]];
+                out[i] = sum;
+            }
+        };
+
+        const size_t MIN_ROWS_PER_THREAD = 4096;
+        size_t threads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), size() / MIN_ROWS_PER_THREAD);
+        if (threads <= 1)
+        {
+            rows(0, size());
+            return;
+        }
+        std::vector<std::thread> workers;
+        size_t chunk = (size() + threads - 1) / threads;
+        for (size_t begin = chunk; begin < size(); begin += chunk)
+            workers.emplace_back(rows, begin, std::min(size(), begin + chunk));
+        rows(0, chunk);
+        for (std::thread &t : workers)
+            t.join();
+    }
+};
+
+// Accumulates one stencil row, merging repeated sources
+struct StencilRow
+{
+    std::vector<std::pair<unsigned int, float>> terms;
+
+    void add(unsigned int source, float weight)
+    {
+        for (auto &term : terms)
+        {
+            if (term.first == source)
+            {
+                term.second += weight;
+                return;
+            }
+        }
+        terms.emplace_back(source, weight);
+    }
+
+    void emit(StencilTable &table)
+    {
+        for (auto &term : terms)
+        {
+            table.sources.push_back(term.first);
+            table.weights.push_back(term.second);
+        }
+        table.offsets.push_back((unsigned int)table.sources.size());
+        terms.clear();
+    }
+};
+
+// Half-edge of the longest edge of every triangle; -1 when it is not clearly
+// longest (near-equilateral triangles are not the halves of a quad)
+inline std::vector<int> longestEdges(const HalfEdgeMesh &he, const std::vector<glm::vec3> &positions)
+{
+    std::vector<int> longest(he.faceCount(), -1);
+    for (unsigned int f = 0; f < he.faceCount(); ++f)
+    {
+        float len[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            unsigned int h = f * 3 + k;
+            glm::vec3 d = positions[he.destination(h)] - positions[he.origin[h]];
+            len[k] = glm::dot(d, d);
+        }
+        int k = (len[0] >= len[1] && len[0] >= len[2]) ? 0 : (len[1] >= len[2] ? 1 : 2);
+        if (len[k] > 1.02f * std::max(len[(k + 1) % 3], len[(k + 2) % 3]))
+            longest[f] = (int)(f * 3 + k);
+    }
+    return longest;
+}
+
+// Triangles that share their mutual longest edge are the two halves of a quad.
+// Returns the polygon list (offsets into faceVertices) with such pairs merged.
+inline size_t pairTrianglesIntoQuads(const HalfEdgeMesh &he, const std::vector<glm::vec3> &positions,
+                                     std::vector<unsigned int> &faceOffsets, std::vector<unsigned int> &faceVertices)
+{
+    std::vector<int> longest = longestEdges(he, positions);
+    std::vector<bool> used(he.faceCount(), false);
+    size_t paired = 0;
+    faceOffsets.assign(1, 0);
+    faceVertices.clear();
+    for (unsigned int f = 0; f < he.faceCount(); ++f)
+    {
+        if (used[f])
+            continue;
+        used[f] = true;
+        int h = longest[f];
+        unsigned int t = (h >= 0) ? he.twin[h] : HalfEdgeMesh::INVALID;
+        if (t != HalfEdgeMesh::INVALID && !used[HalfEdgeMesh::face(t)] && longest[HalfEdgeMesh::face(t)] == (int)t)
+        {
+            // (a, b, c) + (b, a, d) -> (a, d, b, c)
+            used[HalfEdgeMesh::face(t)] = true;
+            faceVertices.insert(faceVertices.end(), {he.origin[h], he.origin[HalfEdgeMesh::prev(t)],
+                                                     he.destination(h), he.origin[HalfEdgeMesh::prev(h)]});
+            paired += 2;
+        }
+        else
+        {
+            faceVertices.insert(faceVertices.end(), {he.origin[f * 3], he.origin[f * 3 + 1], he.origin[f * 3 + 2]});
+        }
+        faceOffsets.push_back((unsigned int)faceVertices.size());
+    }
+    return paired;
+}
+
+// Catmull-Clark when at least half of the triangles pair up into quads
+inline SubdivisionScheme detectSubdivisionScheme(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices)
+{
+    HalfEdgeMesh he;
+    he.build(vertices, indices, true);
+    std::vector<glm::vec3> positions(he.vertexCount());
+    for (size_t v = 0; v < positions.size(); ++v)
+        positions[v] = vertices[he.vertexSource[v]].position;
+    std::vector<unsigned int> offsets, polygons;
+    size_t paired = pairTrianglesIntoQuads(he, positions, offsets, polygons);
+    return (he.faceCount() > 0 && paired * 2 >= he.faceCount()) ? SUBDIVIDE_CATMULL_CLARK : SUBDIVIDE_LOOP;
+}
+
+// Subdivision surface over a fixed control mesh topology. The constructor
+// precomputes one stencil table per level (and the final triangles), so
+// refine() on moved control points is only a sparse matrix-vector product per
+// level. Vertices are welded by position: the limit surface is smooth, so
+// per-face colors and normals of the control mesh are averaged away.
+class SubdivisionSurface
+{
+public:
+    SubdivisionScheme scheme;
+    std::vector<StencilTable> stencils; // level i maps level i vertices to level i + 1
+    std::vector<unsigned int> controlSource; // input vertex giving each control point its position
+    std::vector<unsigned int> cornerSource;  // input vertex of every triangle corner
+    std::vector<unsigned int> cornerControl; // control point of every triangle corner
+    std::vector<unsigned int> triangles;     // finest level
+
+    SubdivisionSurface(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices,
+                       int levels, SubdivisionScheme scheme)
+        : scheme(scheme)
+    {
+        HalfEdgeMesh he;
+        he.build(vertices, indices, true);
+        controlSource = he.vertexSource;
+        cornerSource = he.corner;
+        cornerControl = he.origin;
+        size_t vertexCount = he.vertexCount();
+
+        if (scheme == SUBDIVIDE_LOOP)
+        {
+            std::vector<unsigned int> faces = he.toTopologyIndices();
+            for (int level = 0; level < levels; ++level)
+            {
+                if (level > 0)
+                    he.build(faces, vertexCount);
+                stencils.emplace_back();
+                faces = loopLevel(he, stencils.back());
+                vertexCount = stencils.back().size();
+            }
+            triangles = faces;
+        }
+        else
+        {
+            std::vector<glm::vec3> positions(vertexCount);
+            for (size_t v = 0; v < vertexCount; ++v)
+                positions[v] = vertices[controlSource[v]].position;
+            std::vector<unsigned int> faceOffsets, faceVertices;
+            pairTrianglesIntoQuads(he, positions, faceOffsets, faceVertices);
+            for (int level = 0; level < levels; ++level)
+            {
+                stencils.emplace_back();
+                catmullClarkLevel(faceOffsets, faceVertices, vertexCount, stencils.back());
+                vertexCount = stencils.back().size();
+            }
+            for (size_t f = 0; f + 1 < faceOffsets.size(); ++f)
+                for (unsigned int k = faceOffsets[f] + 1; k + 1 < faceOffsets[f + 1]; ++k)
+                    triangles.insert(triangles.end(), {faceVertices[faceOffsets[f]], faceVertices[k], faceVertices[k + 1]});
+        }
+    }
+
+    size_t refinedVertexCount() const { return stencils.empty() ? controlSource.size() : stencils.back().size(); }
+
+    // Refines positions and colors of base (same layout as the constructor input)
+    // and recomputes smooth normals. Control point colors average the corners
+    // welded into them; the corner normals are refined alongside as a reference
+    // orientation, since parts of a loaded model may be wound either way.
+    void refine(const std::vector<Vertex> &base, std::vector<Vertex> &outVertices, std::vector<unsigned int> &outIndices) const
+    {
+        std::vector<glm::vec3> positions(controlSource.size()), colors(controlSource.size(), glm::vec3(0.0f)),
+            reference(controlSource.size(), glm::vec3(0.0f)), scratch;
+        std::vector<float> cornerCount(controlSource.size(), 0.0f);
+        for (size_t v = 0; v < controlSource.size(); ++v)
+            positions[v] = base[controlSource[v]].position;
+        for (size_t c = 0; c < cornerSource.size(); ++c)
+        {
+            colors[cornerControl[c]] += base[cornerSource[c]].color;
+            reference[cornerControl[c]] += base[cornerSource[c]].normal;
+            cornerCount[cornerControl[c]] += 1.0f;
+        }
+        for (size_t v = 0; v < controlSource.size(); ++v)
+            colors[v] = (cornerCount[v] > 0.0f) ? colors[v] / cornerCount[v] : base[controlSource[v]].color;
+        for (const StencilTable &table : stencils)
+        {
+            table.apply(positions, scratch);
+            positions.swap(scratch);
+            table.apply(colors, scratch);
+            colors.swap(scratch);
+            table.apply(reference, scratch);
+            reference.swap(scratch);
+        }
+
+        std::vector<glm::vec3> normals(positions.size(), glm::vec3(0.0f));
+        for (size_t i = 0; i + 2 < triangles.size(); i += 3)
+        {
+            unsigned int a = triangles[i], b = triangles[i + 1], c = triangles[i + 2];
+            glm::vec3 n = glm::cross(positions[b] - positions[a], positions[c] - positions[a]); // area weighted
+            normals[a] += n;
+            normals[b] += n;
+            normals[c] += n;
+        }
+        outVertices.resize(positions.size());
+        for (size_t v = 0; v < positions.size(); ++v)
+        {
+            float len = glm::length(normals[v]);
+            float sign = (glm::dot(normals[v], reference[v]) < 0.0f) ? -1.0f : 1.0f;
+            outVertices[v].position = positions[v];
+            outVertices[v].color = colors[v];
+            outVertices[v].normal = (len > 0.0f) ? normals[v] * (sign / len) : glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+        outIndices = triangles;
+    }
+
+private:
+    // Even vertices keep their index, edge vertices follow. Returns the new triangles.
+    static std::vector<unsigned int> loopLevel(const HalfEdgeMesh &he, StencilTable &table)
+    {
+        size_t n = he.vertexCount();
+        std::vector<unsigned int> faceCount(n, 0);
+        for (unsigned int v : he.origin)
+            faceCount[v]++;
+
+        StencilRow row;
+        for (unsigned int v = 0; v < n; ++v)
+        {
+            unsigned int fan = 0, last = HalfEdgeMesh::INVALID;
+            he.forEachOutgoing(v, [&](unsigned int h)
+                               { fan++; last = h; });
+
+            if (fan == 0 || fan != faceCount[v])
+            {
+                // isolated or non-manifold: pinned
+                row.add(v, 1.0f);
+            }
+            else if (he.isBorderVertex(v))
+            {
+                row.add(v, 0.75f);
+                row.add(he.destination(he.vertexEdge[v]), 0.125f);
+                row.add(he.origin[HalfEdgeMesh::prev(last)], 0.125f);
+            }
+            else
+            {
+                float valence = (float)fan;
+                float beta = (fan == 3) ? 3.0f / 16.0f : 3.0f / (8.0f * valence);
+                row.add(v, 1.0f - valence * beta);
+                he.forEachOutgoing(v, [&](unsigned int h)
+                                   { row.add(he.destination(h), beta); });
+            }
+            row.emit(table);
+        }
+
+        std::vector<unsigned int> edgeVertex(he.halfEdgeCount(), HalfEdgeMesh::INVALID);
+        unsigned int next = (unsigned int)n;
+        for (unsigned int h = 0; h < he.halfEdgeCount(); ++h)
+        {
+            unsigned int t = he.twin[h];
+            if (t != HalfEdgeMesh::INVALID && t < h)
+                continue;
+            edgeVertex[h] = next++;
+            unsigned int a = he.origin[h], b = he.destination(h);
+            if (t == HalfEdgeMesh::INVALID)
+            {
+                row.add(a, 0.5f);
+                row.add(b, 0.5f);
+            }
+            else
+            {
+                edgeVertex[t] = edgeVertex[h];
+                row.add(a, 0.375f);
+                row.add(b, 0.375f);
+                row.add(he.origin[HalfEdgeMesh::prev(h)], 0.125f);
+                row.add(he.origin[HalfEdgeMesh::prev(t)], 0.125f);
+            }
+            row.emit(table);
+        }
+
+        std::vector<unsigned int> faces;
+        faces.reserve(he.halfEdgeCount() * 4);
+        for (unsigned int f = 0; f < he.faceCount(); ++f)
+        {
+            unsigned int v0 = he.origin[f * 3], v1 = he.origin[f * 3 + 1], v2 = he.origin[f * 3 + 2];
+            unsigned int e0 = edgeVertex[f * 3], e1 = edgeVertex[f * 3 + 1], e2 = edgeVertex[f * 3 + 2];
+            faces.insert(faces.end(), {v0, e0, e2, v1, e1, e0, v2, e2, e1, e0, e1, e2});
+        }
+        return faces;
+    }
+
+    // Vertices keep their index, then one point per face and per edge. Every
+    // polygon becomes one quad per corner, so all faces are quads afterwards.
+    static void catmullClarkLevel(std::vector<unsigned int> &faceOffsets, std::vector<unsigned int> &faceVertices,
+                                  size_t vertexCount, StencilTable &table)
+    {
+        struct Edge
+        {
+            unsigned int a, b;
+            unsigned int faces[2];
+            unsigned int faceCount;
+        };
+        size_t faceCount = faceOffsets.size() - 1;
+        std::vector<Edge> edges;
+        std::unordered_map<uint64_t, unsigned int> edgeIds;
+        std::vector<unsigned int> cornerEdge(faceVertices.size());
+        for (unsigned int f = 0; f < faceCount; ++f)
+        {
+            unsigned int begin = faceOffsets[f], size = faceOffsets[f + 1] - begin;
+            for (unsigned int k = 0; k < size; ++k)
+            {
+                unsigned int a = faceVertices[begin + k], b = faceVertices[begin + (k + 1) % size];
+                uint64_t key = ((uint64_t)std::min(a, b) << 32) | std::max(a, b);
+                auto it = edgeIds.emplace(key, (unsigned int)edges.size());
+                if (it.second)
+                    edges.push_back({a, b, {f, f}, 0});
+                Edge &e = edges[it.first->second];
+                if (e.faceCount < 2)
+                    e.faces[e.faceCount] = f;
+                e.faceCount++;
+                cornerEdge[begin + k] = it.first->second;
+            }
+        }
+
+        std::vector<std::vector<unsigned int>> vertexFaces(vertexCount), vertexEdges(vertexCount);
+        for (unsigned int f = 0; f < faceCount; ++f)
+            for (unsigned int k = faceOffsets[f]; k < faceOffsets[f + 1]; ++k)
+                vertexFaces[faceVertices[k]].push_back(f);
+        for (unsigned int e = 0; e < edges.size(); ++e)
+        {
+            vertexEdges[edges[e].a].push_back(e);
+            vertexEdges[edges[e].b].push_back(e);
+        }
+
+        StencilRow row;
+        auto addFacePoint = [&](unsigned int f, float weight)
+        {
+            float share = weight / (float)(faceOffsets[f + 1] - faceOffsets[f]);
+            for (unsigned int k = faceOffsets[f]; k < faceOffsets[f + 1]; ++k)
+                row.add(faceVertices[k], share);
+        };
+
+        for (unsigned int v = 0; v < vertexCount; ++v)
+        {
+            std::vector<unsigned int> border;
+            for (unsigned int e : vertexEdges[v])
+                if (edges[e].faceCount != 2)
+                    border.push_back(edges[e].a == v ? edges[e].b : edges[e].a);
+
+            size_t valence = vertexEdges[v].size();
+            if (border.empty() && valence >= 3 && valence == vertexFaces[v].size())
+            {
+                // (Q + 2R + (n - 3)S) / n with Q the face point and R the edge midpoint averages
+                float n = (float)valence;
+                row.add(v, (n - 3.0f) / n);
+                for (unsigned int f : vertexFaces[v])
+                    addFacePoint(f, 1.0f / (n * n));
+                for (unsigned int e : vertexEdges[v])
+                {
+                    row.add(edges[e].a, 1.0f / (n * n));
+                    row.add(edges[e].b, 1.0f / (n * n));
+                }
+            }
+            else if (border.size() == 2)
+            {
+                row.add(v, 0.75f);
+                row.add(border[0], 0.125f);
+                row.add(border[1], 0.125f);
+            }
+            else
+            {
+                // corners and non-manifold vertices are pinned
+                row.add(v, 1.0f);
+            }
+            row.emit(table);
+        }
+
+        for (unsigned int f = 0; f < faceCount; ++f)
+        {
+            addFacePoint(f, 1.0f);
+            row.emit(table);
+        }
+
+        unsigned int firstEdgePoint = (unsigned int)(vertexCount + faceCount);
+        for (const Edge &e : edges)
+        {
+            if (e.faceCount == 2)
+            {
+                row.add(e.a, 0.25f);
+                row.add(e.b, 0.25f);
+                addFacePoint(e.faces[0], 0.25f);
+                addFacePoint(e.faces[1], 0.25f);
+            }
+            else
+            {
+                row.add(e.a, 0.5f);
+                row.add(e.b, 0.5f);
+            }
+            row.emit(table);
+        }
+
+        std::vector<unsigned int> offsets{0}, quads;
+        quads.reserve(faceVertices.size() * 4);
+        for (unsigned int f = 0; f < faceCount; ++f)
+        {
+            unsigned int begin = faceOffsets[f], size = faceOffsets[f + 1] - begin;
+            unsigned int center = (unsigned int)vertexCount + f;
+            for (unsigned int k = 0; k < size; ++k)
+            {
+                unsigned int incoming = cornerEdge[begin + (k + size - 1) % size];
+                quads.insert(quads.end(), {faceVertices[begin + k], firstEdgePoint + cornerEdge[begin + k],
+                                           center, firstEdgePoint + incoming});
+                offsets.push_back((unsigned int)quads.size());
+            }
+        }
+        faceOffsets.swap(offsets);
+        faceVertices.swap(quads);
+    }
+};
+
+// Convenience for load-time refinement
+inline void subdivideMesh(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices, int levels,
+                          const char *label = nullptr)
+{
+    PROFILE_SCOPE("subdivideMesh");
+    if (levels <= 0 || indices.empty())
+        return;
+    SubdivisionScheme scheme = detectSubdivisionScheme(vertices, indices);
+    SubdivisionSurface surface(vertices, indices, levels, scheme);
+    size_t before = indices.size() / 3;
+    std::vector<Vertex> refined;
+    surface.refine(vertices, refined, indices);
+    vertices.swap(refined);
+    if (label)
+    {
+        std::cout << "[INFO] (SUBDIV) " << label << ": " << (scheme == SUBDIVIDE_LOOP ? "Loop" : "Catmull-Clark")
+                  << " x" << levels << ", " << before << " -> " << indices.size() / 3 << " triangles" << std::endl;
+    }
+}
+
+#endif
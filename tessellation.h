@@ -0,0 +1,142 @@
+#ifndef TESSELLATION_H
+#define TESSELLATION_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include "mesh.h"
+#include "primitives.h"
+#include "profiler.h"
+
+#include <map>
+#include <tuple>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+enum PrimitiveShape
+{
+    SHAPE_CYLINDER,
+    SHAPE_CONE,
+    SHAPE_SPHERE,
+    SHAPE_TORUS,
+    SHAPE_CYLINDER_SECTOR,
+};
+
+// Analytic description of a procedural primitive. segments (and minorSegments
+// for sphere stacks / torus tube segments) are the authored, finest tessellation;
+// coarser levels halve them. radius/height/sweep follow the create* functions,
+// except for the torus where radius is the main radius and height the tube radius.
+struct PrimitiveDesc
+{
+    PrimitiveShape shape;
+    float radius;
+    float height;
+    int segments;
+    glm::vec3 color;
+    float sweep = 360.0f;
+    int minorSegments = 0;
+
+    bool operator<(const PrimitiveDesc &o) const
+    {
+        return std::make_tuple(shape, radius, height, segments, minorSegments, sweep, color.x, color.y, color.z) <
+               std::make_tuple(o.shape, o.radius, o.height, o.segments, o.minorSegments, o.sweep, o.color.x, o.color.y, o.color.z);
+    }
+
+    // segment counts of a level, level 0 being the authored one
+    int levelSegments(int level) const { return std::max((shape == SHAPE_CYLINDER_SECTOR) ? 1 : 3, segments >> level); }
+    int levelMinorSegments(int level) const { return std::max((shape == SHAPE_SPHERE) ? 2 : 3, minorSegments >> level); }
+
+    int levelCount() const
+    {
+        int count = 1;
+        while (levelSegments(count) < levelSegments(count - 1) ||
+               (minorSegments > 0 && levelMinorSegments(count) < levelMinorSegments(count - 1)))
+            count++;
+        return count;
+    }
+
+    // max distance between the tessellation and the true surface (chord sagitta)
+    float levelError(int level) const
+    {
+        int n = levelSegments(level);
+        int m = levelMinorSegments(level);
+        auto sagitta = [](float r, float angle)
+        { return r * (1.0f - std::cos(angle * 0.5f)); };
+
+        switch (shape)
+        {
+        case SHAPE_SPHERE:
+            // slices span the full circle, stacks a half circle
+            return std::max(sagitta(radius, glm::two_pi<float>() / n), sagitta(radius, glm::pi<float>() / m));
+        case SHAPE_TORUS:
+            return std::max(sagitta(radius + height, glm::two_pi<float>() / n), sagitta(height, glm::two_pi<float>() / m));
+        case SHAPE_CYLINDER_SECTOR:
+            return sagitta(radius, glm::radians(sweep) / n);
+        default:
+            return sagitta(radius, glm::two_pi<float>() / n);
+        }
+    }
+
+    Mesh build(int level) const
+    {
+        int n = levelSegments(level);
+        int m = levelMinorSegments(level);
+        switch (shape)
+        {
+        case SHAPE_CONE:
+            return createCone(radius, height, n, color);
+        case SHAPE_SPHERE:
+            return createSphere(radius, m, n, color, true);
+        case SHAPE_TORUS:
+            return createTorus(radius, height, n, m, color, true);
+        case SHAPE_CYLINDER_SECTOR:
+            return createCylinderSector(radius, height, sweep, n, color);
+        default:
+            return createCylinder(radius, height, n, color);
+        }
+    }
+};
+
+// Every tessellation level of every primitive description, built on first use
+// and shared by all instances with the same description.
+class TessellationCache
+{
+public:
+    Mesh &get(const PrimitiveDesc &desc, int level)
+    {
+        std::vector<Mesh> &levels = cache[desc];
+        if (levels.empty())
+            levels.resize(desc.levelCount());
+        level = glm::clamp(level, 0, (int)levels.size() - 1);
+        if (levels[level].VAO == 0)
+        {
+            PROFILE_SCOPE("tessellatePrimitive");
+            levels[level] = desc.build(level);
+        }
+        return levels[level];
+    }
+
+    // coarsest level whose error stays under maxPixelError
+    int select(const PrimitiveDesc &desc, float pixelsPerUnit, float maxPixelError) const
+    {
+        for (int level = desc.levelCount() - 1; level > 0; --level)
+        {
+            if (desc.levelError(level) * pixelsPerUnit <= maxPixelError)
+                return level;
+        }
+        return 0;
+    }
+
+    void rebuildEdges(float featureAngle)
+    {
+        for (auto &entry : cache)
+            for (Mesh &mesh : entry.second)
+                if (mesh.VAO != 0)
+                    mesh.rebuildEdges(featureAngle);
+    }
+
+private:
+    std::map<PrimitiveDesc, std::vector<Mesh>> cache;
+};
+
+#endif
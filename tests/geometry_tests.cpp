@@ -0,0 +1,175 @@
+// Invariant checks for the mesh processing headers. Only CPU-side code runs
+// here, so no GL context is needed (glad is linked for the symbols mesh.h names).
+
+#include "mesh.h"
+#include "halfedge.h"
+#include "subdivision.h"
+#include "simplify.h"
+#include "meshlet.h"
+
+#include <vector>
+#include <algorithm>
+#include <array>
+#include <iostream>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                        \
+    do                                                                                          \
+    {                                                                                           \
+        if (!(condition))                                                                       \
+        {                                                                                       \
+            std::cerr << "[ERROR] " << __FILE__ << ":" << __LINE__ << ": " #condition << std::endl; \
+            failures++;                                                                         \
+        }                                                                                       \
+    } while (0)
+
+struct TestMesh
+{
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+};
+
+static Vertex makeVertex(glm::vec3 position)
+{
+    return Vertex{position, glm::normalize(position), glm::vec3(1.0f)};
+}
+
+// Eight shared corners, two triangles per side, wound counter-clockwise from outside
+static TestMesh cube()
+{
+    TestMesh mesh;
+    for (int i = 0; i < 8; ++i)
+        mesh.vertices.push_back(makeVertex(glm::vec3(i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f)));
+    const unsigned int quads[6][4] = {
+        {0, 4, 6, 2}, {1, 3, 7, 5}, // -x, +x
+        {0, 1, 5, 4}, {2, 6, 7, 3}, // -y, +y
+        {0, 2, 3, 1}, {4, 5, 7, 6}, // -z, +z
+    };
+    for (const auto &q : quads)
+        mesh.indices.insert(mesh.indices.end(), {q[0], q[1], q[2], q[0], q[2], q[3]});
+    return mesh;
+}
+
+static TestMesh icosahedron()
+{
+    TestMesh mesh;
+    const float t = (1.0f + std::sqrt(5.0f)) * 0.5f;
+    const glm::vec3 corners[12] = {
+        {-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0},
+        {0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t},
+        {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1},
+    };
+    for (const glm::vec3 &c : corners)
+        mesh.vertices.push_back(makeVertex(glm::normalize(c)));
+    mesh.indices = {0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11,
+                    1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+                    3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9,
+                    4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1};
+    return mesh;
+}
+
+// Every half-edge of a closed mesh has a twin running the other way
+static void checkClosed(const TestMesh &mesh)
+{
+    HalfEdgeMesh he;
+    he.build(mesh.vertices, mesh.indices, true);
+    CHECK(he.isManifold());
+    CHECK(he.borderLoops().empty());
+    for (unsigned int h = 0; h < he.halfEdgeCount(); ++h)
+    {
+        CHECK(he.twin[h] != HalfEdgeMesh::INVALID);
+        if (he.twin[h] == HalfEdgeMesh::INVALID)
+            continue;
+        CHECK(he.twin[he.twin[h]] == h);
+        CHECK(he.origin[he.twin[h]] == he.destination(h));
+    }
+}
+
+// V - E + F over the welded topology
+static long eulerCharacteristic(const TestMesh &mesh)
+{
+    HalfEdgeMesh he;
+    he.build(mesh.vertices, mesh.indices, true);
+    return (long)he.vertexCount() - (long)he.halfEdgeCount() / 2 + (long)he.faceCount();
+}
+
+static void testSubdivision(TestMesh mesh, SubdivisionScheme expected)
+{
+    CHECK(detectSubdivisionScheme(mesh.vertices, mesh.indices) == expected);
+    size_t before = mesh.indices.size() / 3;
+    subdivideMesh(mesh.vertices, mesh.indices, 2);
+    CHECK(mesh.indices.size() / 3 > before);
+    CHECK(eulerCharacteristic(mesh) == 2);
+    checkClosed(mesh);
+}
+
+static void testSimplify(TestMesh mesh)
+{
+    subdivideMesh(mesh.vertices, mesh.indices, 2);
+    size_t target = mesh.indices.size() / 4 / 3 * 3;
+    std::vector<unsigned int> lod = simplifyMesh(mesh.vertices, mesh.indices, target);
+    CHECK(lod.size() % 3 == 0);
+    CHECK(lod.size() >= 3);
+    CHECK(lod.size() <= target);
+    for (unsigned int index : lod)
+        CHECK(index < mesh.vertices.size());
+}
+
+// The clusters' ranges tile the reordered list and it holds the same triangles
+static void testMeshlets(TestMesh mesh)
+{
+    subdivideMesh(mesh.vertices, mesh.indices, 3);
+    std::vector<unsigned int> ordered = mesh.indices;
+    MeshletSet set;
+    set.build(mesh.vertices, ordered);
+    CHECK(!set.empty());
+    CHECK(ordered.size() == mesh.indices.size());
+
+    std::vector<int> covered(ordered.size(), 0);
+    for (const Meshlet &m : set.meshlets)
+    {
+        CHECK(m.indexCount % 3 == 0);
+        CHECK(m.indexCount / 3 <= MeshletSet::MAX_TRIANGLES);
+        CHECK(m.vertexCount <= MeshletSet::MAX_VERTICES);
+        CHECK(m.firstIndex + m.indexCount <= ordered.size());
+        for (unsigned int i = m.firstIndex; i < m.firstIndex + m.indexCount && i < covered.size(); ++i)
+            covered[i]++;
+    }
+    CHECK(std::all_of(covered.begin(), covered.end(), [](int c) { return c == 1; }));
+
+    auto triangles = [](const std::vector<unsigned int> &indices)
+    {
+        std::vector<std::array<unsigned int, 3>> list;
+        for (size_t t = 0; t + 2 < indices.size(); t += 3)
+        {
+            // rotate the smallest index first so winding is kept but start corner is not
+            size_t first = std::min_element(indices.begin() + t, indices.begin() + t + 3) - indices.begin() - t;
+            list.push_back({indices[t + first], indices[t + (first + 1) % 3], indices[t + (first + 2) % 3]});
+        }
+        std::sort(list.begin(), list.end());
+        return list;
+    };
+    CHECK(triangles(ordered) == triangles(mesh.indices));
+}
+
+int main()
+{
+    checkClosed(cube());
+    checkClosed(icosahedron());
+    CHECK(eulerCharacteristic(cube()) == 2);
+    CHECK(eulerCharacteristic(icosahedron()) == 2);
+
+    testSubdivision(cube(), SUBDIVIDE_CATMULL_CLARK);
+    testSubdivision(icosahedron(), SUBDIVIDE_LOOP);
+    testSimplify(icosahedron());
+    testMeshlets(icosahedron());
+
+    if (failures)
+    {
+        std::cerr << "[ERROR] (TEST) " << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "[INFO] (TEST) geometry checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,185 @@
+#ifndef TEXT_OVERLAY_H
+#define TEXT_OVERLAY_H
+
+#include <glad/glad.h>
+#include "shader.h"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+// Lines of text in the top-left corner of the viewport, over a translucent
+// panel, for debug readouts. The font is 3x5 pixels and built in: every glyph
+// is 15 bits, and the fragment shader of a character's quad looks its pixel up
+// in them, so there is no font texture to load. Letters come out upper case.
+class TextOverlay
+{
+public:
+    static const int SCALE = 3;   // screen pixels per font pixel
+    static const int CELL_W = 4;  // font pixels per character, with spacing
+    static const int CELL_H = 7;  // font pixels per line, with spacing
+    static const int MARGIN = 2;  // font pixels of panel around the text
+
+    // Needs a current GL 3.3 context
+    void create()
+    {
+        shader = std::make_unique<Shader>(Shader::fromSource(VERTEX_SHADER, FRAGMENT_SHADER));
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, x));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, u));
+        glEnableVertexAttribArray(1);
+        glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(Vertex), (void *)offsetof(Vertex, glyph));
+        glEnableVertexAttribArray(2);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void destroy()
+    {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        if (shader)
+            glDeleteProgram(shader->id);
+        shader.reset();
+        VAO = VBO = 0;
+    }
+
+    // Draws over whatever is in the bound framebuffer, leaving depth testing,
+    // blending and face culling as they were and no program or VAO bound
+    void draw(const std::vector<std::string> &lines)
+    {
+        if (!shader || lines.empty())
+            return;
+
+        size_t columns = 0;
+        for (const std::string &line : lines)
+            columns = std::max(columns, line.size());
+        vertices.clear();
+        quad(0.0f, 0.0f, (float)(columns * CELL_W + 2 * MARGIN - 1), (float)(lines.size() * CELL_H + 2 * MARGIN - 2), PANEL);
+        for (size_t row = 0; row < lines.size(); ++row)
+        {
+            for (size_t column = 0; column < lines[row].size(); ++column)
+            {
+                uint32_t bits = glyph(lines[row][column]);
+                if (bits != 0)
+                    quad((float)(MARGIN + column * CELL_W), (float)(MARGIN + row * CELL_H), 3.0f, 5.0f, bits);
+            }
+        }
+
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST), blend = glIsEnabled(GL_BLEND), cullFace = glIsEnabled(GL_CULL_FACE);
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_CULL_FACE);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        shader->use();
+        shader->setVec2("uViewport", (float)viewport[2], (float)viewport[3]);
+        shader->setFloat("uScale", (float)SCALE);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STREAM_DRAW);
+        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertices.size());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+        glUseProgram(0);
+
+        if (depthTest)
+            glEnable(GL_DEPTH_TEST);
+        if (cullFace)
+            glEnable(GL_CULL_FACE);
+        if (!blend)
+            glDisable(GL_BLEND);
+    }
+
+private:
+    static const uint32_t PANEL = 0xFFFFu; // glyph value of the background quad
+
+    struct Vertex
+    {
+        float x, y; // font pixels from the top-left corner
+        float u, v; // font pixels within the glyph
+        uint32_t glyph;
+    };
+
+    std::unique_ptr<Shader> shader;
+    unsigned int VAO = 0, VBO = 0;
+    std::vector<Vertex> vertices;
+
+    void quad(float x, float y, float w, float h, uint32_t bits)
+    {
+        Vertex a{x, y, 0.0f, 0.0f, bits}, b{x + w, y, w, 0.0f, bits};
+        Vertex c{x + w, y + h, w, h, bits}, d{x, y + h, 0.0f, h, bits};
+        vertices.insert(vertices.end(), {a, b, c, a, c, d});
+    }
+
+    // Bit row * 3 + column is set where the glyph has a pixel, row 0 at the top
+    static uint32_t glyph(char c)
+    {
+        static const uint16_t GLYPHS[64] = {
+            0x0000, 0x2092, 0x002D, 0x5F7D, 0x3C9E, 0x52A5, 0x6AAA, 0x0012, //  !"#$%&'
+            0x224A, 0x2922, 0x0AA8, 0x05D0, 0x1400, 0x01C0, 0x2000, 0x12A4, // ()*+,-./
+            0x7B6F, 0x749A, 0x73E7, 0x79A7, 0x49ED, 0x79CF, 0x7BCF, 0x2527, // 01234567
+            0x7BEF, 0x79EF, 0x0410, 0x1410, 0x4454, 0x0E38, 0x1511, 0x20A7, // 89:;<=>?
+            0x636A, 0x5BEA, 0x3AEB, 0x624E, 0x3B6B, 0x72CF, 0x12CF, 0x6B4E, // @ABCDEFG
+            0x5BED, 0x7497, 0x2B24, 0x5AED, 0x7249, 0x5BFD, 0x5B6B, 0x2B6A, // HIJKLMNO
+            0x12EB, 0x676A, 0x5AEB, 0x388E, 0x2497, 0x7B6D, 0x2B6D, 0x5FED, // PQRSTUVW
+            0x5AAD, 0x24AD, 0x72A7, 0x324B, 0x4889, 0x6926, 0x002A, 0x7000, // XYZ[\]^_
+        };
+        if (c >= 'a' && c <= 'z')
+            c = (char)(c - 'a' + 'A');
+        if (c < ' ' || c > '_')
+            c = '?';
+        return GLYPHS[c - ' '];
+    }
+
+    static constexpr const char *VERTEX_SHADER = R"(#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aCell;
+layout (location = 2) in uint aGlyph;
+
+uniform vec2 uViewport;
+uniform float uScale;
+
+out vec2 vCell;
+flat out uint vGlyph;
+
+void main()
+{
+    vec2 pixels = aPos * uScale;
+    gl_Position = vec4(pixels.x / uViewport.x * 2.0 - 1.0, 1.0 - pixels.y / uViewport.y * 2.0, 0.0, 1.0);
+    vCell = aCell;
+    vGlyph = aGlyph;
+}
+)";
+
+    static constexpr const char *FRAGMENT_SHADER = R"(#version 330 core
+in vec2 vCell;
+flat in uint vGlyph;
+
+out vec4 FragColor;
+
+void main()
+{
+    if (vGlyph == 0xFFFFu)
+    {
+        FragColor = vec4(0.0, 0.0, 0.0, 0.6);
+        return;
+    }
+    ivec2 pixel = min(ivec2(vCell), ivec2(2, 4));
+    if (((vGlyph >> uint(pixel.y * 3 + pixel.x)) & 1u) == 0u)
+        discard;
+    FragColor = vec4(1.0, 1.0, 0.6, 1.0);
+}
+)";
+};
+
+#endif